@@ -0,0 +1,17 @@
+/*
+ * alloc_count.h — heap allocation counting for the benchmark harness.
+ *
+ * alloc_count.c interposes malloc/calloc/realloc via RTLD_NEXT, so
+ * every allocation in the process — glib, the bridge, the Go runtime's
+ * cgo shims — is counted. Benchmarks snapshot the counter around a
+ * timed region to report allocations per message.
+ */
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+#include <glib.h>
+
+/* Total malloc/calloc/realloc calls since process start. */
+guint64 wm_alloc_count(void);
+
+#endif /* ALLOC_COUNT_H */
@@ -0,0 +1,203 @@
+/*
+ * bench.c — bridge microbenchmark harness (`make bench` / cmake `bench`).
+ *
+ * Links the real marshal queue, the real formatting converter, and the
+ * real Go archive against the mock libpurple layer in mock_purple.c,
+ * then drives synthetic load through the hot paths:
+ *
+ *   delivery   batches of 64 messages through bridge_receive_messages,
+ *              the marshal queue, and a full main-loop drain
+ *   presence   batches of 32 coalesced updates through
+ *              bridge_presence_updates and the drain
+ *   format     HTML → WhatsApp and WhatsApp → HTML conversion
+ *   cgo        raw C→Go crossing cost (no-op export) and the
+ *              unconnected-account send front-end
+ *
+ * Reported numbers are messages (or calls) per second, allocations per
+ * message via the interposed counters in alloc_count.c, and CGO
+ * crossings per second. Single run, wall clock — meant for comparing
+ * two builds on the same machine, not absolute truth.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "marshal.h"
+#include "format.h"
+#include "alloc_count.h"
+#include "mock_purple.h"
+
+#define BATCH_MSGS      64
+#define BATCH_PRESENCE  32
+#define DELIVERY_ITERS  20000
+#define PRESENCE_ITERS  20000
+#define FORMAT_ITERS    200000
+#define CGO_ITERS       1000000
+#define SEND_ITERS      200000
+
+/* A fake-but-valid account handle: the Go side looks it up, finds no
+ * registered account, and returns on the error path — which is exactly
+ * the crossing + lookup cost we want to measure. */
+#define BENCH_ACCOUNT ((gowhatsapp_account_t)0x1)
+
+/* ────────────────────────────────────────────────────────────────
+ * Synthetic batch construction (arena format from bridge.h)
+ * ──────────────────────────────────────────────────────────────── */
+
+static uint32_t arena_put(GByteArray *arena, const char *s) {
+    uint32_t off = arena->len;
+    g_byte_array_append(arena, (const guint8 *)s, strlen(s) + 1);
+    return off;
+}
+
+static void build_message_batch(bridge_message_t *msgs, GByteArray *arena) {
+    for (int i = 0; i < BATCH_MSGS; i++) {
+        char jid[64], id[32], text[128];
+        g_snprintf(jid, sizeof(jid), "65%08d@s.whatsapp.net", i);
+        g_snprintf(id, sizeof(id), "3EB0%028d", i);
+        g_snprintf(text, sizeof(text),
+            "benchmark message %d with a plausible amount of text in it", i);
+        msgs[i].sender_jid_off = arena_put(arena, jid);
+        msgs[i].chat_jid_off   = msgs[i].sender_jid_off;
+        msgs[i].text_off       = arena_put(arena, text);
+        msgs[i].message_id_off = arena_put(arena, id);
+        msgs[i].push_name_off  = arena_put(arena, "Bench Contact");
+        msgs[i].timestamp      = 1700000000 + i;
+        msgs[i].from_me        = 0;
+        msgs[i].is_group       = 0;
+    }
+}
+
+static void build_presence_batch(bridge_presence_t *pres, GByteArray *arena) {
+    for (int i = 0; i < BATCH_PRESENCE; i++) {
+        char jid[64];
+        g_snprintf(jid, sizeof(jid), "65%08d@s.whatsapp.net", i);
+        pres[i].jid_off = arena_put(arena, jid);
+        pres[i].kind    = i & 1;
+        pres[i].state   = (i >> 1) & 1;
+    }
+}
+
+/* Drain everything the marshal queue scheduled on the main context. */
+static void pump(void) {
+    while (g_main_context_iteration(NULL, FALSE)) {
+        /* keep iterating until idle */
+    }
+}
+
+/* ────────────────────────────────────────────────────────────────
+ * Benchmarks
+ * ──────────────────────────────────────────────────────────────── */
+
+static void bench_delivery(void) {
+    bridge_message_t msgs[BATCH_MSGS];
+    GByteArray *arena = g_byte_array_new();
+    build_message_batch(msgs, arena);
+
+    guint64 allocs0 = wm_alloc_count();
+    guint64 cross0 = wm_bench_stats.crossings;
+    gint64 t0 = g_get_monotonic_time();
+
+    for (int i = 0; i < DELIVERY_ITERS; i++) {
+        bridge_receive_messages(BENCH_ACCOUNT, msgs, BATCH_MSGS,
+            (const char *)arena->data, (int)arena->len);
+        pump();
+    }
+
+    gint64 us = g_get_monotonic_time() - t0;
+    guint64 total = (guint64)DELIVERY_ITERS * BATCH_MSGS;
+    guint64 allocs = wm_alloc_count() - allocs0;
+    guint64 cross = wm_bench_stats.crossings - cross0;
+
+    printf("delivery  %12.0f msgs/sec  %6.2f allocs/msg  %10.0f crossings/sec\n",
+        total * 1e6 / us, (double)allocs / total, cross * 1e6 / us);
+
+    g_byte_array_free(arena, TRUE);
+}
+
+static void bench_presence(void) {
+    bridge_presence_t pres[BATCH_PRESENCE];
+    GByteArray *arena = g_byte_array_new();
+    build_presence_batch(pres, arena);
+
+    guint64 allocs0 = wm_alloc_count();
+    gint64 t0 = g_get_monotonic_time();
+
+    for (int i = 0; i < PRESENCE_ITERS; i++) {
+        bridge_presence_updates(BENCH_ACCOUNT, pres, BATCH_PRESENCE,
+            (const char *)arena->data, (int)arena->len);
+        pump();
+    }
+
+    gint64 us = g_get_monotonic_time() - t0;
+    guint64 total = (guint64)PRESENCE_ITERS * BATCH_PRESENCE;
+    guint64 allocs = wm_alloc_count() - allocs0;
+
+    printf("presence  %12.0f upds/sec  %6.2f allocs/upd\n",
+        total * 1e6 / us, (double)allocs / total);
+
+    g_byte_array_free(arena, TRUE);
+}
+
+static void bench_format(void) {
+    static const char *html =
+        "Some <b>bold</b> and <i>italic</i> text with &amp; entities "
+        "and a<br>line break in a message-sized string";
+    static const char *markers =
+        "Some *bold* and _italic_ text with ~struck~ words and "
+        "```monospace``` in a message-sized string";
+
+    gint64 t0 = g_get_monotonic_time();
+    for (int i = 0; i < FORMAT_ITERS; i++) {
+        g_free(wm_format_html_to_whatsapp(html));
+    }
+    gint64 us = g_get_monotonic_time() - t0;
+    printf("format    %12.0f html→wa/sec", FORMAT_ITERS * 1e6 / us);
+
+    t0 = g_get_monotonic_time();
+    for (int i = 0; i < FORMAT_ITERS; i++) {
+        g_free(wm_format_whatsapp_to_html(markers));
+    }
+    us = g_get_monotonic_time() - t0;
+    printf("  %12.0f wa→html/sec\n", FORMAT_ITERS * 1e6 / us);
+}
+
+static void bench_cgo(void) {
+    /* Pure crossing cost: all-zero arguments make the export a no-op. */
+    gint64 t0 = g_get_monotonic_time();
+    for (int i = 0; i < CGO_ITERS; i++) {
+        gowhatsapp_go_configure_runtime(0, 0, 0);
+    }
+    gint64 us = g_get_monotonic_time() - t0;
+    printf("cgo       %12.0f crossings/sec", CGO_ITERS * 1e6 / us);
+
+    /* Send front-end: crossing + account lookup + error return. */
+    t0 = g_get_monotonic_time();
+    for (int i = 0; i < SEND_ITERS; i++) {
+        gowhatsapp_go_send_message(BENCH_ACCOUNT,
+            "6512345678@s.whatsapp.net", "benchmark");
+    }
+    us = g_get_monotonic_time() - t0;
+    printf("  %12.0f sends/sec (unconnected)\n", SEND_ITERS * 1e6 / us);
+}
+
+int main(void) {
+    wm_event_queue_init(wm_bench_dispatch);
+
+    printf("whatsmeow-lite bridge microbenchmarks\n");
+    printf("batch sizes: %d messages, %d presence updates\n\n",
+        BATCH_MSGS, BATCH_PRESENCE);
+
+    bench_delivery();
+    bench_presence();
+    bench_format();
+    bench_cgo();
+
+    printf("\ntotals: %" G_GUINT64_FORMAT " messages, %" G_GUINT64_FORMAT
+        " arena bytes walked, %" G_GUINT64_FORMAT " Go→C crossings\n",
+        wm_bench_stats.messages, wm_bench_stats.string_bytes,
+        wm_bench_stats.crossings);
+    return 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * mock_purple.h — counters exposed by the mock libpurple layer.
+ *
+ * The benchmark harness links the real marshal queue and the real Go
+ * archive, but swaps plugin.c (which needs a live libpurple) for mock
+ * implementations of the Go→C bridge callbacks. The mocks enqueue
+ * through the same one-malloc copy path as plugin.c and the mock
+ * dispatcher consumes batches the way the real handlers do — touching
+ * every struct field and arena string — but updates counters instead of
+ * driving UI.
+ */
+#ifndef MOCK_PURPLE_H
+#define MOCK_PURPLE_H
+
+#include <glib.h>
+
+#include "marshal.h"
+
+typedef struct {
+    guint64 crossings;      /* Go→C callback invocations */
+    guint64 messages;       /* messages consumed by the mock dispatcher */
+    guint64 presence;       /* presence updates consumed */
+    guint64 string_bytes;   /* arena string bytes walked during consumption */
+} wm_bench_stats_t;
+
+extern wm_bench_stats_t wm_bench_stats;
+
+/* Main-thread dispatch function for wm_event_queue_init() — the mock
+ * stand-in for plugin.c's wm_dispatch_event. */
+void wm_bench_dispatch(wm_event_t *ev);
+
+#endif /* MOCK_PURPLE_H */
@@ -0,0 +1,155 @@
+/*
+ * archive.c — mmap reader for the local message archive.
+ *
+ * See archive.h for the on-disk format (written by archive.go). Backfill
+ * maps the per-chat .idx/.dat pair read-only, seeks to the newest N
+ * index entries, and replays those records into the conversation. Every
+ * field is bounds-checked against the mapping before use — a truncated
+ * or corrupt archive degrades to a shorter backfill, never a crash.
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <purple.h>
+
+#include "archive.h"
+#include "format.h"
+
+/* A read-only file mapping. data == NULL when the file is absent/empty. */
+typedef struct {
+    const char *data;
+    size_t len;
+} wm_map_t;
+
+static gboolean wm_map_open(const char *path, wm_map_t *map) {
+    map->data = NULL;
+    map->len = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return FALSE;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return FALSE;
+    }
+
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);    /* the mapping keeps its own reference */
+    if (data == MAP_FAILED) return FALSE;
+
+    map->data = data;
+    map->len = (size_t)st.st_size;
+    return TRUE;
+}
+
+static void wm_map_close(wm_map_t *map) {
+    if (map->data != NULL) {
+        munmap((void *)map->data, map->len);
+    }
+}
+
+/* Build "<purple dir>/whatsmeow/archive/<phone>/<jid>" — the Go side
+ * derives the same stem from the account phone and the chat JID. */
+static char *archive_base_path(PurpleAccount *pa, const char *chat_jid) {
+    const char *username = purple_account_get_username(pa);
+    const char *at = strchr(username, '@');
+    char *phone = at ? g_strndup(username, at - username) : g_strdup(username);
+
+    char *safe = g_strdup(chat_jid);
+    for (char *p = safe; *p != '\0'; p++) {
+        if (*p == '/') *p = '_';
+    }
+
+    char *base = g_strdup_printf("%s/whatsmeow/archive/%s/%s",
+        purple_user_dir(), phone, safe);
+    g_free(phone);
+    g_free(safe);
+    return base;
+}
+
+/* Replay one record into the conversation; records at or past the
+ * cutoff are skipped, not replayed. Returns FALSE if the record does
+ * not fit inside the mapping. */
+static gboolean replay_record(PurpleConversation *conv, const wm_map_t *dat,
+                              size_t off, gint64 before_ts) {
+    if (off + 4 > dat->len) return FALSE;
+
+    uint32_t len;
+    memcpy(&len, dat->data + off, 4);
+    len = GUINT32_FROM_LE(len);
+    if (len < 9 || off + 4 + len > dat->len) return FALSE;
+
+    const char *payload = dat->data + off + 4;
+    const char *end = payload + len;
+
+    int64_t ts;
+    memcpy(&ts, payload, 8);
+    ts = GINT64_FROM_LE(ts);
+    uint8_t rec_flags = (uint8_t)payload[8];
+
+    const char *sender = payload + 9;
+    const char *sender_end = memchr(sender, '\0', (size_t)(end - sender));
+    if (sender_end == NULL) return FALSE;
+
+    const char *text = sender_end + 1;
+    if (text >= end || memchr(text, '\0', (size_t)(end - text)) == NULL) {
+        return FALSE;
+    }
+
+    /* The record that triggered this backfill (and anything newer) is
+     * being delivered live — replaying it too would double-render. */
+    if ((gint64)ts >= before_ts) return TRUE;
+
+    /* Delayed + no-log: these messages are already in the archive and
+     * were logged by purple when they first arrived. */
+    PurpleMessageFlags flags = PURPLE_MESSAGE_DELAYED | PURPLE_MESSAGE_NO_LOG;
+    flags |= (rec_flags & 1) ? PURPLE_MESSAGE_SEND : PURPLE_MESSAGE_RECV;
+
+    /* The archive stores raw WhatsApp text, but purple renders this
+     * argument as HTML — convert exactly like the live path does, which
+     * also escapes &, < and > (remote text must never reach the UI as
+     * markup). */
+    char *markup = wm_format_whatsapp_to_html(text);
+    purple_conversation_write(conv, sender, markup, flags, (time_t)ts);
+    g_free(markup);
+    return TRUE;
+}
+
+void wm_archive_backfill(PurpleConversation *conv, int max_messages,
+                         gint64 before_ts) {
+    if (max_messages <= 0) return;
+
+    PurpleAccount *pa = purple_conversation_get_account(conv);
+    char *base = archive_base_path(pa, purple_conversation_get_name(conv));
+    char *idx_path = g_strdup_printf("%s.idx", base);
+    char *dat_path = g_strdup_printf("%s.dat", base);
+    g_free(base);
+
+    wm_map_t idx, dat;
+    if (wm_map_open(idx_path, &idx)) {
+        if (wm_map_open(dat_path, &dat)) {
+            size_t count = idx.len / 8;
+            size_t first = (count > (size_t)max_messages)
+                ? count - (size_t)max_messages : 0;
+
+            for (size_t i = first; i < count; i++) {
+                uint64_t off;
+                memcpy(&off, idx.data + i * 8, 8);
+                off = GUINT64_FROM_LE(off);
+                if (!replay_record(conv, &dat, (size_t)off, before_ts)) break;
+            }
+            wm_map_close(&dat);
+        }
+        wm_map_close(&idx);
+    }
+
+    g_free(idx_path);
+    g_free(dat_path);
+}
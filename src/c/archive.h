@@ -0,0 +1,35 @@
+/*
+ * archive.h — mmap reader for the local message archive.
+ *
+ * The Go side (archive.go) appends every delivered and sent message to a
+ * per-chat binary archive next to the session DB:
+ *
+ *   <jid>.dat — records, little-endian, each:
+ *       uint32  len     payload bytes after this field
+ *       int64   ts      unix seconds
+ *       uint8   flags   bit 0: from_me
+ *       sender  NUL-terminated
+ *       text    NUL-terminated
+ *   <jid>.idx — one uint64 per record: byte offset of its len field in
+ *               the .dat file, so the newest N records are a seek away.
+ *
+ * This reader maps the pair read-only when a conversation window opens
+ * and replays the tail into it — milliseconds, versus purple's HTML log
+ * parser. Main-thread only.
+ */
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <purple.h>
+
+/* Backfill the newest `max_messages` archived messages into a freshly
+ * created conversation. Only records strictly older than `before_ts`
+ * (unix seconds) are replayed — when the conversation was created by an
+ * incoming message, that message is already in the archive and would
+ * otherwise render twice; pass G_MAXINT64 for no cutoff. Quietly does
+ * nothing if the chat has no archive yet. Must run on the purple main
+ * loop. */
+void wm_archive_backfill(PurpleConversation *conv, int max_messages,
+                         gint64 before_ts);
+
+#endif /* ARCHIVE_H */
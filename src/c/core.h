@@ -0,0 +1,43 @@
+/*
+ * core.h — contract between the thin prpl shim and the bridge core.
+ *
+ * The plugin ships as two libraries: libwhatsmeow-lite.so, a tiny shim
+ * that registers the protocol with libpurple at scan time, and
+ * libwhatsmeow-core.so, which carries the multi-megabyte Go archive and
+ * all bridge logic. The shim dlopens the core on the first login, so
+ * merely having the plugin installed costs Pidgin neither Go runtime
+ * initialization nor the page-in of the archive.
+ *
+ * The core exports exactly one symbol, wm_core_init(); everything else
+ * is reached through the ops table it returns.
+ */
+#ifndef CORE_H
+#define CORE_H
+
+#include <purple.h>
+
+#define WM_PLUGIN_ID "prpl-whatsmeow-lite"
+
+/* Protocol callbacks implemented by the core, mirrored by the shim's
+ * PurplePluginProtocolInfo entries. */
+typedef struct {
+    void (*login)(PurpleAccount *account);
+    void (*close)(PurpleConnection *gc);
+    int (*send_im)(PurpleConnection *gc, const char *who,
+                   const char *message, PurpleMessageFlags flags);
+    unsigned int (*send_typing)(PurpleConnection *gc, const char *name,
+                                PurpleTypingState state);
+    int (*chat_send)(PurpleConnection *gc, int id,
+                     const char *message, PurpleMessageFlags flags);
+    /* Render the bridge performance counters (C queue + Go side) as
+     * plain text. Caller frees with g_free(). */
+    char *(*stats_dump)(void);
+} wm_core_ops_t;
+
+/* Core entry point, resolved via dlsym. Initializes the event queue,
+ * caches, signal handlers, and Go runtime tuning (idempotent), and
+ * returns the ops table. `plugin` is the shim's plugin handle, used for
+ * signal connections. */
+typedef const wm_core_ops_t *(*wm_core_init_fn)(PurplePlugin *plugin);
+
+#endif /* CORE_H */
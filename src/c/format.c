@@ -0,0 +1,193 @@
+/*
+ * format.c — Pidgin HTML ↔ WhatsApp formatting conversion.
+ *
+ * See format.h. Both converters are single forward passes over the
+ * input; the only lookahead is bounded (to a tag's '>' or a span's
+ * closing marker on the same line). No purple calls — safe from any
+ * thread, though in practice only the main loop uses it.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "format.h"
+
+/* ────────────────────────────────────────────────────────────────
+ * HTML → WhatsApp (outgoing)
+ * ──────────────────────────────────────────────────────────────── */
+
+static gboolean tag_is(const char *name, size_t len, const char *want) {
+    return strlen(want) == len && g_ascii_strncasecmp(name, want, len) == 0;
+}
+
+/* Decode one entity at `p` ('&'). Appends the replacement (or the raw
+ * '&' when unrecognized) and returns the input bytes consumed. */
+static size_t decode_entity(GString *out, const char *p) {
+    static const struct { const char *name; char repl; } entities[] = {
+        { "&amp;",  '&'  },
+        { "&lt;",   '<'  },
+        { "&gt;",   '>'  },
+        { "&quot;", '"'  },
+        { "&apos;", '\'' },
+        { "&nbsp;", ' '  },
+    };
+
+    for (size_t i = 0; i < G_N_ELEMENTS(entities); i++) {
+        size_t len = strlen(entities[i].name);
+        if (strncmp(p, entities[i].name, len) == 0) {
+            g_string_append_c(out, entities[i].repl);
+            return len;
+        }
+    }
+    g_string_append_c(out, '&');
+    return 1;
+}
+
+char *wm_format_html_to_whatsapp(const char *html) {
+    /* Fast path: nothing to parse, nothing to decode. */
+    if (strpbrk(html, "<&") == NULL) {
+        return g_strdup(html);
+    }
+
+    GString *out = g_string_sized_new(strlen(html));
+    const char *p = html;
+
+    while (*p != '\0') {
+        if (*p == '&') {
+            p += decode_entity(out, p);
+            continue;
+        }
+        if (*p != '<') {
+            g_string_append_c(out, *p);
+            p++;
+            continue;
+        }
+
+        const char *end = strchr(p, '>');
+        if (end == NULL) {
+            /* Unterminated tag — emit the rest verbatim. */
+            g_string_append(out, p);
+            break;
+        }
+
+        gboolean closing = (p[1] == '/');
+        const char *name = p + (closing ? 2 : 1);
+        size_t nlen = 0;
+        while (name + nlen < end && g_ascii_isalnum(name[nlen])) {
+            nlen++;
+        }
+
+        /* Paired tags map to the same marker on both sides. */
+        if (tag_is(name, nlen, "b") || tag_is(name, nlen, "strong")) {
+            g_string_append_c(out, '*');
+        } else if (tag_is(name, nlen, "i") || tag_is(name, nlen, "em")) {
+            g_string_append_c(out, '_');
+        } else if (tag_is(name, nlen, "s") || tag_is(name, nlen, "strike") ||
+                   tag_is(name, nlen, "del")) {
+            g_string_append_c(out, '~');
+        } else if (tag_is(name, nlen, "tt") || tag_is(name, nlen, "code") ||
+                   tag_is(name, nlen, "pre")) {
+            g_string_append(out, "```");
+        } else if (tag_is(name, nlen, "br") && !closing) {
+            g_string_append_c(out, '\n');
+        }
+        /* Any other tag (font, a, span, ...) is dropped. */
+
+        p = end + 1;
+    }
+
+    return g_string_free(out, FALSE);
+}
+
+/* ────────────────────────────────────────────────────────────────
+ * WhatsApp → HTML (incoming)
+ * ──────────────────────────────────────────────────────────────── */
+
+/* Append `len` bytes HTML-escaped. */
+static void append_escaped(GString *out, const char *s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        switch (s[i]) {
+        case '&': g_string_append(out, "&amp;"); break;
+        case '<': g_string_append(out, "&lt;");  break;
+        case '>': g_string_append(out, "&gt;");  break;
+        default:  g_string_append_c(out, s[i]);  break;
+        }
+    }
+}
+
+/* Find the closing marker for a span opened at text[start-1]: the next
+ * `marker` on the same line that is preceded by a non-space. Returns
+ * NULL when the span does not close. */
+static const char *find_span_close(const char *text, size_t start, char marker) {
+    for (const char *c = text + start; *c != '\0' && *c != '\n'; c++) {
+        if (*c == marker && !g_ascii_isspace(c[-1])) {
+            return c;
+        }
+    }
+    return NULL;
+}
+
+/* Try to convert a marker span starting at text[i]. Appends the tagged,
+ * escaped content and returns the index just past the closing marker,
+ * or `i` unchanged when this is not a valid span. Nested markers inside
+ * the span pass through literally. */
+static size_t try_span(GString *out, const char *text, size_t i,
+                       char marker, const char *tag) {
+    /* Opening marker: word boundary before, non-space content after. */
+    if (i > 0 && !g_ascii_isspace(text[i - 1])) return i;
+    char next = text[i + 1];
+    if (next == '\0' || next == marker || g_ascii_isspace(next)) return i;
+
+    const char *close = find_span_close(text, i + 1, marker);
+    if (close == NULL) return i;
+
+    g_string_append_printf(out, "<%s>", tag);
+    append_escaped(out, text + i + 1, (size_t)(close - (text + i + 1)));
+    g_string_append_printf(out, "</%s>", tag);
+    return (size_t)(close - text) + 1;
+}
+
+/* Try to convert a ```monospace``` span starting at text[i]. */
+static size_t try_mono_span(GString *out, const char *text, size_t i) {
+    if (strncmp(text + i, "```", 3) != 0) return i;
+
+    const char *close = strstr(text + i + 3, "```");
+    if (close == NULL || close == text + i + 3) return i;
+
+    g_string_append(out, "<tt>");
+    append_escaped(out, text + i + 3, (size_t)(close - (text + i + 3)));
+    g_string_append(out, "</tt>");
+    return (size_t)(close - text) + 3;
+}
+
+char *wm_format_whatsapp_to_html(const char *text) {
+    /* Fast path: no markers, nothing needing escape. */
+    if (strpbrk(text, "*_~`&<>") == NULL) {
+        return g_strdup(text);
+    }
+
+    size_t len = strlen(text);
+    GString *out = g_string_sized_new(len + 16);
+
+    size_t i = 0;
+    while (i < len) {
+        size_t after = i;
+        switch (text[i]) {
+        case '*': after = try_span(out, text, i, '*', "b"); break;
+        case '_': after = try_span(out, text, i, '_', "i"); break;
+        case '~': after = try_span(out, text, i, '~', "s"); break;
+        case '`': after = try_mono_span(out, text, i);      break;
+        default: break;
+        }
+        if (after != i) {
+            i = after;
+            continue;
+        }
+
+        append_escaped(out, text + i, 1);
+        i++;
+    }
+
+    return g_string_free(out, FALSE);
+}
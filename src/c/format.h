@@ -0,0 +1,27 @@
+/*
+ * format.h — Pidgin HTML ↔ WhatsApp formatting conversion.
+ *
+ * Outgoing messages used to go through purple_markup_strip_html(): a
+ * full HTML parse per message that also discarded the bold/italic the
+ * user typed. These converters are single-pass and preserve formatting
+ * by mapping between Pidgin's HTML subset and WhatsApp's markers
+ * (*bold*, _italic_, ~strike~, ```monospace```). Both directions start
+ * with a byte scan that returns a plain copy when no markup is present,
+ * so the common plain-text message pays near-zero cost.
+ */
+#ifndef FORMAT_H
+#define FORMAT_H
+
+/* Convert Pidgin's HTML subset to WhatsApp formatting: tags mapped to
+ * markers, <br> to newline, entities decoded, unknown tags dropped.
+ * Returns a newly allocated string; caller frees. */
+char *wm_format_html_to_whatsapp(const char *html);
+
+/* Convert WhatsApp formatting markers in incoming text to Pidgin HTML,
+ * escaping &, < and > along the way. Markers only convert when they
+ * delimit a plausible span (word boundary before, non-space after, a
+ * closer on the same line); stray markers pass through literally.
+ * Returns a newly allocated string; caller frees. */
+char *wm_format_whatsapp_to_html(const char *text);
+
+#endif /* FORMAT_H */
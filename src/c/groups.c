@@ -0,0 +1,96 @@
+/*
+ * groups.c — main-thread group metadata cache.
+ *
+ * See groups.h. Keyed like the other per-account caches in plugin.c
+ * ("%p/%s" of account and chat JID). Entries are replaced wholesale on
+ * each update — participant lists are small and updates are rare, so
+ * there is nothing to gain from diffing here; the Go side already
+ * coalesces and only pushes on change.
+ */
+
+#include <string.h>
+
+#include <purple.h>
+
+#include "groups.h"
+
+typedef struct {
+    char *subject;
+    char **jids;            /* participant JIDs */
+    gboolean *admins;       /* parallel to jids */
+    int count;
+} wm_group_entry;
+
+static GHashTable *group_cache;     /* "account/chat_jid" → wm_group_entry */
+
+static void group_entry_free(gpointer data) {
+    wm_group_entry *entry = data;
+    for (int i = 0; i < entry->count; i++) {
+        g_free(entry->jids[i]);
+    }
+    g_free(entry->jids);
+    g_free(entry->admins);
+    g_free(entry->subject);
+    g_free(entry);
+}
+
+static char *group_key(gowhatsapp_account_t account, const char *chat_jid) {
+    return g_strdup_printf("%p/%s", (void *)account, chat_jid);
+}
+
+void wm_groups_update(
+    gowhatsapp_account_t account,
+    const char *chat_jid,
+    const char *subject,
+    const bridge_participant_t *participants,
+    int count,
+    const char *arena
+) {
+    if (group_cache == NULL) {
+        group_cache = g_hash_table_new_full(g_str_hash, g_str_equal,
+            g_free, group_entry_free);
+    }
+
+    wm_group_entry *entry = g_new0(wm_group_entry, 1);
+    entry->subject = g_strdup(subject);
+    entry->count = count;
+    entry->jids = g_new0(char *, count);
+    entry->admins = g_new0(gboolean, count);
+    for (int i = 0; i < count; i++) {
+        entry->jids[i] = g_strdup(arena + participants[i].jid_off);
+        entry->admins[i] = participants[i].is_admin != 0;
+    }
+
+    g_hash_table_replace(group_cache, group_key(account, chat_jid), entry);
+}
+
+void wm_groups_populate(PurpleAccount *pa, PurpleConversation *conv,
+                        const char *chat_jid) {
+    if (group_cache == NULL) return;
+
+    char *key = group_key((gowhatsapp_account_t)pa, chat_jid);
+    wm_group_entry *entry = g_hash_table_lookup(group_cache, key);
+    g_free(key);
+    if (entry == NULL) return;
+
+    PurpleConvChat *chat = PURPLE_CONV_CHAT(conv);
+
+    if (entry->subject != NULL && entry->subject[0] != '\0') {
+        purple_conversation_set_title(conv, entry->subject);
+        purple_conv_chat_set_topic(chat, NULL, entry->subject);
+    }
+
+    /* Rebuild the member list in one add_users call. */
+    purple_conv_chat_clear_users(chat);
+    GList *users = NULL, *flags = NULL;
+    for (int i = 0; i < entry->count; i++) {
+        users = g_list_prepend(users, entry->jids[i]);
+        flags = g_list_prepend(flags, GINT_TO_POINTER(
+            entry->admins[i] ? PURPLE_CBFLAGS_OP : PURPLE_CBFLAGS_NONE));
+    }
+    if (users != NULL) {
+        purple_conv_chat_add_users(chat, users, NULL, flags, FALSE);
+    }
+    g_list_free(users);
+    g_list_free(flags);
+}
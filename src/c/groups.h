@@ -0,0 +1,31 @@
+/*
+ * groups.h — main-thread group metadata cache.
+ *
+ * Stores the subject and participant list pushed by the Go side
+ * (bridge_group_metadata) so that opening a group chat populates its
+ * user list and topic instantly from memory — the Go side owns fetching
+ * and persistence, this side only caches and applies. Main-thread only.
+ */
+#ifndef GROUPS_H
+#define GROUPS_H
+
+#include <purple.h>
+
+#include "bridge.h"
+
+/* Replace the cached metadata for one group. Copies everything. */
+void wm_groups_update(
+    gowhatsapp_account_t account,
+    const char *chat_jid,
+    const char *subject,
+    const bridge_participant_t *participants,
+    int count,
+    const char *arena
+);
+
+/* Populate an open group conversation's user list and topic from the
+ * cache. No-op when the group is not cached yet. */
+void wm_groups_populate(PurpleAccount *pa, PurpleConversation *conv,
+                        const char *chat_jid);
+
+#endif /* GROUPS_H */
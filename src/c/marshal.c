@@ -0,0 +1,114 @@
+/*
+ * marshal.c — lock-free MPSC event queue, drained on the purple main loop.
+ *
+ * Producers (whatsmeow goroutines) push with a compare-and-swap onto an
+ * intrusive LIFO head; the consumer (a g_idle_add callback) detaches the
+ * whole chain with one swap, reverses it to FIFO order, and dispatches.
+ * A single atomic flag ensures at most one idle source is pending at a
+ * time — the fix for the wakeup storm from busy group chats.
+ */
+
+#include <string.h>
+
+#include "marshal.h"
+
+static wm_event_t *queue_head;          /* Treiber stack of pending events */
+static volatile gint drain_scheduled;   /* 1 while an idle drain is pending */
+static void (*dispatch_fn)(wm_event_t *ev);
+
+/* Stats counters. `pushed` sees concurrent producers (atomic add);
+ * `drains`/`peak_batch` are touched only by the main-loop consumer. */
+static guint64 stat_pushed;
+static guint64 stat_drains;
+static guint64 stat_peak_batch;
+
+void wm_event_queue_init(void (*dispatch)(wm_event_t *ev)) {
+    dispatch_fn = dispatch;
+}
+
+wm_event_t *wm_event_new(wm_event_type_t type, gowhatsapp_account_t account) {
+    wm_event_t *ev = g_new0(wm_event_t, 1);
+    ev->type = type;
+    ev->account = account;
+    return ev;
+}
+
+void wm_event_free(wm_event_t *ev) {
+    g_free(ev->str1);
+    g_free(ev->str2);
+    g_free(ev->msgs);   /* arena lives inside the same allocation */
+    g_free(ev->pres);
+    g_free(ev->media);
+    g_free(ev->rcpts);
+    g_free(ev->parts);
+    g_free(ev->icons);
+    g_free(ev->bres);
+    g_free(ev->contacts);
+    g_free(ev);
+}
+
+static gboolean wm_event_drain(gpointer data) {
+    (void)data;
+
+    /* Clear the flag before detaching so a push racing with us schedules
+     * a fresh drain rather than being lost. */
+    g_atomic_int_set(&drain_scheduled, 0);
+
+    wm_event_t *head;
+    do {
+        head = g_atomic_pointer_get(&queue_head);
+    } while (head != NULL &&
+             !g_atomic_pointer_compare_and_exchange(&queue_head, head, NULL));
+
+    /* The stack is LIFO; reverse to dispatch in arrival order. */
+    wm_event_t *ordered = NULL;
+    guint64 chain_len = 0;
+    while (head != NULL) {
+        wm_event_t *next = head->next;
+        head->next = ordered;
+        ordered = head;
+        head = next;
+        chain_len++;
+    }
+
+    stat_drains++;
+    if (chain_len > stat_peak_batch) {
+        stat_peak_batch = chain_len;
+    }
+
+    while (ordered != NULL) {
+        wm_event_t *ev = ordered;
+        ordered = ev->next;
+        dispatch_fn(ev);
+        wm_event_free(ev);
+    }
+
+    return FALSE;
+}
+
+void wm_event_queue_stats(guint64 *pushed, guint64 *drains, guint64 *peak_batch) {
+    if (pushed != NULL) {
+        *pushed = __atomic_load_n(&stat_pushed, __ATOMIC_RELAXED);
+    }
+    if (drains != NULL) {
+        *drains = stat_drains;
+    }
+    if (peak_batch != NULL) {
+        *peak_batch = stat_peak_batch;
+    }
+}
+
+void wm_event_push(wm_event_t *ev) {
+    __atomic_add_fetch(&stat_pushed, 1, __ATOMIC_RELAXED);
+
+    wm_event_t *old;
+    do {
+        old = g_atomic_pointer_get(&queue_head);
+        ev->next = old;
+    } while (!g_atomic_pointer_compare_and_exchange(&queue_head, old, ev));
+
+    /* g_idle_add is thread-safe; schedule at most one drain at a time. */
+    if (g_atomic_int_compare_and_exchange(&drain_scheduled, 0, 1)) {
+        g_idle_add(wm_event_drain, NULL);
+    }
+}
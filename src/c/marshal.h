@@ -0,0 +1,80 @@
+/*
+ * marshal.h — Go→C event marshaling onto the purple main loop.
+ *
+ * libpurple is not thread-safe, but the bridge callbacks in bridge.h are
+ * invoked from whatsmeow goroutines. This layer decouples the two: the
+ * callback implementations encode each event into a wm_event_t and push
+ * it onto a lock-free MPSC queue (Treiber stack, producers = goroutines,
+ * consumer = main loop). A single idle callback drains the whole queue
+ * per wakeup, so a burst of N events costs one main-loop wakeup instead
+ * of N, and every purple call runs on the main thread.
+ */
+#ifndef MARSHAL_H
+#define MARSHAL_H
+
+#include <glib.h>
+
+#include "bridge.h"
+
+/* Event discriminator — one value per bridge callback. */
+typedef enum {
+    WM_EV_QR_CODE,
+    WM_EV_CONNECTING,
+    WM_EV_CONNECTED,
+    WM_EV_DISCONNECTED,
+    WM_EV_ERROR,
+    WM_EV_MESSAGES,
+    WM_EV_MEDIA,
+    WM_EV_SEND_RESULT,
+    WM_EV_PRESENCE_BATCH,
+    WM_EV_RECEIPT_BATCH,
+    WM_EV_GROUP_META,
+    WM_EV_BUDDY_ICONS,
+    WM_EV_BROADCAST_RESULTS,
+    WM_EV_CONTACT_SYNC
+} wm_event_type_t;
+
+/* One queued bridge event. Payload fields are owned by the event and
+ * released by wm_event_free(); unused fields stay NULL/0. */
+typedef struct wm_event {
+    struct wm_event *next;      /* intrusive queue link */
+    wm_event_type_t type;
+    gowhatsapp_account_t account;
+
+    char *str1;                 /* qr data / error text / jid */
+    char *str2;                 /* server id */
+    bridge_message_t *msgs;     /* WM_EV_MESSAGES: packed batch (structs) */
+    bridge_presence_t *pres;    /* WM_EV_PRESENCE_BATCH: packed batch */
+    bridge_media_t *media;      /* WM_EV_MEDIA: packed media message */
+    bridge_receipt_t *rcpts;    /* WM_EV_RECEIPT_BATCH: packed batch */
+    bridge_participant_t *parts;/* WM_EV_GROUP_META: packed participants */
+    bridge_icon_t *icons;       /* WM_EV_BUDDY_ICONS: packed batch */
+    bridge_broadcast_result_t *bres; /* WM_EV_BROADCAST_RESULTS: packed batch */
+    bridge_contact_t *contacts; /* WM_EV_CONTACT_SYNC: packed roster */
+    const char *arena;          /* batched events: string arena inside the block */
+    int count;                  /* batched events: batch size */
+    guint64 u64;                /* send token */
+    gint64 i64;                 /* server timestamp */
+    int i1;                     /* status / available / composing */
+} wm_event_t;
+
+/* Install the main-thread dispatch function. Must be called once, from
+ * plugin init, before any event can be pushed. */
+void wm_event_queue_init(void (*dispatch)(wm_event_t *ev));
+
+/* Allocate a zeroed event. Safe from any thread. */
+wm_event_t *wm_event_new(wm_event_type_t type, gowhatsapp_account_t account);
+
+/* Push an event and schedule a main-loop drain if one is not already
+ * pending. Safe from any thread; takes ownership of `ev`. */
+void wm_event_push(wm_event_t *ev);
+
+/* Release an event and its payload. Called by the drain loop. */
+void wm_event_free(wm_event_t *ev);
+
+/* Queue counters for the stats dump: events pushed since init, drain
+ * wakeups, and the largest chain consumed by one drain (a proxy for
+ * peak queue depth). Each out-parameter may be NULL. */
+void wm_event_queue_stats(guint64 *pushed, guint64 *drains, guint64 *peak_batch);
+
+#endif /* MARSHAL_H */
@@ -1,15 +1,16 @@
 /*
- * plugin.c — libpurple protocol plugin for WhatsApp via whatsmeow.
+ * plugin.c — bridge core for WhatsApp via whatsmeow.
  *
  * This is the C side of the bridge. It:
- *   1. Registers a protocol plugin with libpurple ("prpl-whatsmeow-lite")
- *   2. Implements libpurple callbacks (login, send_im, chat_send, etc.)
- *   3. Implements Go→C bridge callbacks (bridge_receive_message, etc.)
+ *   1. Implements libpurple protocol callbacks (login, send_im, chat_send)
+ *   2. Implements Go→C bridge callbacks (bridge_receive_messages, etc.)
  *
  * The Go side (whatsmeow_bridge.go) handles all WhatsApp protocol logic.
- *
- * Build: This file is compiled as part of a shared library that links
- *        against both libpurple and the Go static archive.
+ * Protocol registration lives in shim.c: this file is compiled into
+ * libwhatsmeow-core.so together with the Go static archive, and the shim
+ * dlopens it on the first login — Pidgin's plugin scan never touches the
+ * Go runtime. The shim reaches everything here through the ops table
+ * returned by wm_core_init() (see core.h).
  *
  * Security considerations:
  *   - We never handle encryption — that's entirely in whatsmeow (Go side)
@@ -17,6 +18,7 @@
  *   - Session DB lives in ~/.purple/whatsmeow/ with 0600 perms
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
@@ -25,13 +27,25 @@
 /* The bridge header (shared with Go) */
 #include "bridge.h"
 
-/* Plugin metadata */
-#define PLUGIN_ID       "prpl-whatsmeow-lite"
-#define PLUGIN_NAME     "WhatsApp (whatsmeow)"
-#define PLUGIN_VERSION  "0.1.0"
-#define PLUGIN_AUTHOR   "whatsapp-native project"
-#define PLUGIN_URL      "https://github.com/johnny/pidgin-whatsapp"
-#define PLUGIN_SUMMARY  "WhatsApp via whatsmeow — lightweight, E2E encrypted"
+/* Go→C event marshaling onto the main loop */
+#include "marshal.h"
+
+/* mmap reader for the local message archive */
+#include "archive.h"
+
+/* pairing QR code presentation */
+#include "qrcode.h"
+
+/* Pidgin HTML ↔ WhatsApp formatting conversion */
+#include "format.h"
+
+/* group metadata cache (subjects + participant lists) */
+#include "groups.h"
+
+/* shim ↔ core ops table contract */
+#include "core.h"
+
+#define PLUGIN_ID WM_PLUGIN_ID
 
 /* ────────────────────────────────────────────────────────────────
  * Utility: extract phone number from purple account username
@@ -46,37 +60,178 @@ static char *extract_phone(const char *username) {
 }
 
 /* ────────────────────────────────────────────────────────────────
- * Go → C bridge callback implementations
+ * Chat lookup cache
+ *
+ * Maps "account/chat_jid" to a stable chat id and the open conversation,
+ * replacing the per-message purple_find_conversation_with_account() scan
+ * and the collision-prone g_str_hash() chat ids. Ids are assigned from a
+ * monotonic counter and survive conversation close/reopen; the cached
+ * conversation pointer is dropped via the deleting-conversation signal.
+ * Main-thread only, like everything else that touches purple.
  * ──────────────────────────────────────────────────────────────── */
 
-void bridge_show_qr_code(gowhatsapp_account_t account, const char *qr_data) {
+typedef struct {
+    int chat_id;                /* stable, collision-free purple chat id */
+    PurpleConversation *conv;   /* open conversation, or NULL */
+} wm_chat_entry;
+
+static GHashTable *chat_cache;  /* "account/chat_jid" → wm_chat_entry */
+static int next_chat_id = 1;
+
+static char *chat_cache_key(PurpleAccount *pa, const char *chat_jid) {
+    return g_strdup_printf("%p/%s", (void *)pa, chat_jid);
+}
+
+static wm_chat_entry *chat_cache_get(PurpleAccount *pa, const char *chat_jid) {
+    char *key = chat_cache_key(pa, chat_jid);
+    wm_chat_entry *entry = g_hash_table_lookup(chat_cache, key);
+    if (entry != NULL) {
+        g_free(key);
+        return entry;
+    }
+
+    entry = g_new0(wm_chat_entry, 1);
+    entry->chat_id = next_chat_id++;
+    g_hash_table_insert(chat_cache, key, entry);
+    return entry;
+}
+
+/* Signal handler: a conversation is going away — drop the cached pointer
+ * but keep the entry so the chat id stays stable across reopen. */
+static void chat_cache_conv_deleting(PurpleConversation *conv, gpointer data) {
+    (void)data;
+    if (purple_conversation_get_type(conv) != PURPLE_CONV_TYPE_CHAT) return;
+
+    char *key = chat_cache_key(purple_conversation_get_account(conv),
+        purple_conversation_get_name(conv));
+    wm_chat_entry *entry = g_hash_table_lookup(chat_cache, key);
+    if (entry != NULL && entry->conv == conv) {
+        entry->conv = NULL;
+    }
+    g_free(key);
+}
+
+/* ────────────────────────────────────────────────────────────────
+ * Contact cache
+ *
+ * Remembers each JID's buddy pointer and the alias we last applied, so
+ * 1:1 delivery stops calling purple_find_buddy() and (worse)
+ * purple_blist_alias_buddy() — a blist write plus UI refresh — on every
+ * message. The buddy list is only touched when a contact is first seen
+ * or its push name actually changes.
+ * ──────────────────────────────────────────────────────────────── */
+
+typedef struct {
+    PurpleBuddy *buddy;
+    char *alias;                /* alias currently applied to the blist */
+} wm_contact_entry;
+
+static GHashTable *contact_cache;   /* "account/jid" → wm_contact_entry */
+
+static void contact_entry_free(gpointer data) {
+    wm_contact_entry *entry = data;
+    g_free(entry->alias);
+    g_free(entry);
+}
+
+/* Timestamp of the message currently being delivered, or 0 outside
+ * delivery. The Go side archives a message before handing it to us, so
+ * when delivery itself opens the conversation window the triggered
+ * backfill must stop short of the triggering message. */
+static gint64 wm_delivery_cutoff;
+
+/* Signal handler: a conversation window just opened — backfill its tail
+ * from the local message archive so it is not empty while live traffic
+ * (or history sync) catches up. */
+static void wm_conversation_created(PurpleConversation *conv, gpointer data) {
+    (void)data;
+    PurpleAccount *pa = purple_conversation_get_account(conv);
+    if (g_strcmp0(purple_account_get_protocol_id(pa), PLUGIN_ID) != 0) return;
+
+    wm_archive_backfill(conv,
+        purple_account_get_int(pa, "backfill-count", 50),
+        wm_delivery_cutoff != 0 ? wm_delivery_cutoff : G_MAXINT64);
+}
+
+/* Signal handler: a buddy was removed from the blist — forget it so the
+ * next message recreates it instead of using a dangling pointer. */
+static void contact_cache_buddy_removed(PurpleBuddy *buddy, gpointer data) {
+    (void)data;
+    char *key = chat_cache_key(purple_buddy_get_account(buddy),
+        purple_buddy_get_name(buddy));
+    g_hash_table_remove(contact_cache, key);
+    g_free(key);
+}
+
+/* Ensure `jid` exists in the blist with `display` as its alias, touching
+ * purple only on first sight or alias change. */
+static void contact_cache_seen(PurpleAccount *pa, const char *jid,
+                               const char *push_name, const char *display) {
+    char *key = chat_cache_key(pa, jid);
+    wm_contact_entry *entry = g_hash_table_lookup(contact_cache, key);
+
+    if (entry == NULL) {
+        entry = g_new0(wm_contact_entry, 1);
+        entry->buddy = purple_find_buddy(pa, jid);
+        if (entry->buddy == NULL) {
+            entry->buddy = purple_buddy_new(pa, jid, display);
+            purple_blist_add_buddy(entry->buddy, NULL, NULL, NULL);
+            /* Mark it ours: roster sync may only remove buddies the
+             * plugin created, never ones the user added by hand. */
+            purple_blist_node_set_bool((PurpleBlistNode *)entry->buddy,
+                "wm-auto", TRUE);
+            entry->alias = g_strdup(display);
+        } else {
+            /* Seed from the alias actually on the blist — a push name
+             * that changed while Pidgin was closed must still compare
+             * unequal below, or the stale alias sticks forever. */
+            entry->alias = g_strdup(purple_buddy_get_alias_only(entry->buddy));
+        }
+        g_hash_table_insert(contact_cache, key, entry);
+    } else {
+        g_free(key);
+    }
+
+    if (push_name && push_name[0] && g_strcmp0(entry->alias, push_name) != 0) {
+        purple_blist_alias_buddy(entry->buddy, push_name);
+        g_free(entry->alias);
+        entry->alias = g_strdup(push_name);
+    }
+}
+
+/* ────────────────────────────────────────────────────────────────
+ * Main-thread event handlers
+ *
+ * Everything below runs on the purple main loop, dispatched from the
+ * marshal queue — it is the only code allowed to touch libpurple.
+ * ──────────────────────────────────────────────────────────────── */
+
+static void handle_show_qr_code(gowhatsapp_account_t account, const char *qr_data) {
     PurpleAccount *pa = (PurpleAccount *)account;
     PurpleConnection *gc = purple_account_get_connection(pa);
     if (gc == NULL) return;
 
-    /* Display QR code as a request dialog.
-     * In a full implementation, we'd render the QR as an image.
-     * For the PoC, we show the raw code + instructions. */
-    char *msg = g_strdup_printf(
-        "<b>Scan this QR code with your phone:</b><br><br>"
-        "WhatsApp → Settings → Linked Devices → Link a Device<br><br>"
-        "<b>QR Code Data:</b><br>"
-        "<tt>%s</tt><br><br>"
-        "<i>Tip: Copy this string and paste it into a QR code generator, "
-        "or use the terminal QR display if running from command line.</i>",
-        qr_data
-    );
+    /* Rendered in-process when libqrencode + gdk-pixbuf are available;
+     * refreshed in place on each rotation. Text fallback otherwise. */
+    wm_qr_show(gc, qr_data);
+}
 
-    purple_notify_formatted(gc, "WhatsApp QR Code",
-        "Scan to Link Device", NULL, msg, NULL, NULL);
+static void handle_connecting(gowhatsapp_account_t account, const char *stage) {
+    PurpleAccount *pa = (PurpleAccount *)account;
+    PurpleConnection *gc = purple_account_get_connection(pa);
+    if (gc == NULL) return;
 
-    /* Also output to terminal if available (for headless/bitlbee setups) */
-    purple_debug_info(PLUGIN_ID, "QR Code: %s\n", qr_data);
+    /* During a transparent reconnect the gc is still CONNECTED — the
+     * progress API is only valid while connecting, so just log. */
+    if (purple_connection_get_state(gc) == PURPLE_CONNECTED) {
+        purple_debug_info(PLUGIN_ID, "%s\n", stage);
+        return;
+    }
 
-    g_free(msg);
+    purple_connection_update_progress(gc, stage, 1, 3);
 }
 
-void bridge_connected(gowhatsapp_account_t account) {
+static void handle_connected(gowhatsapp_account_t account) {
     PurpleAccount *pa = (PurpleAccount *)account;
     PurpleConnection *gc = purple_account_get_connection(pa);
     if (gc == NULL) return;
@@ -85,7 +240,7 @@ void bridge_connected(gowhatsapp_account_t account) {
     purple_debug_info(PLUGIN_ID, "Connected to WhatsApp\n");
 }
 
-void bridge_disconnected(gowhatsapp_account_t account) {
+static void handle_disconnected(gowhatsapp_account_t account) {
     PurpleAccount *pa = (PurpleAccount *)account;
     PurpleConnection *gc = purple_account_get_connection(pa);
     if (gc == NULL) return;
@@ -95,7 +250,7 @@ void bridge_disconnected(gowhatsapp_account_t account) {
         "Disconnected from WhatsApp");
 }
 
-void bridge_error(gowhatsapp_account_t account, const char *message) {
+static void handle_error(gowhatsapp_account_t account, const char *message) {
     PurpleAccount *pa = (PurpleAccount *)account;
     PurpleConnection *gc = purple_account_get_connection(pa);
     if (gc == NULL) return;
@@ -104,7 +259,7 @@ void bridge_error(gowhatsapp_account_t account, const char *message) {
     purple_notify_error(gc, "WhatsApp Error", message, NULL);
 }
 
-void bridge_receive_message(
+static void deliver_message(
     gowhatsapp_account_t account,
     const char *sender_jid,
     const char *chat_jid,
@@ -113,34 +268,52 @@ void bridge_receive_message(
     const char *push_name,
     long timestamp,
     int from_me,
-    int is_group
+    int is_group,
+    PurpleMessageFlags extra_flags,
+    gboolean ack
 ) {
     PurpleAccount *pa = (PurpleAccount *)account;
+    PurpleConnection *gc = purple_account_get_connection(pa);
+
+    /* Queued events can drain after wm_close tore the connection down
+     * (disconnect while traffic is flowing) — drop them. */
+    if (gc == NULL) return;
 
     if (from_me) {
         /* Echoed outgoing message — could display in conversation */
         return;
     }
 
+    /* serv_got_* below may create the conversation, and the triggered
+     * backfill must not replay this message's archive record. */
+    wm_delivery_cutoff = (gint64)timestamp;
+
     if (is_group) {
-        /* Group message: find or create the chat conversation */
-        PurpleConversation *conv = purple_find_conversation_with_account(
-            PURPLE_CONV_TYPE_CHAT, chat_jid, pa);
+        /* Group message: O(1) cache hit on the hot path */
+        wm_chat_entry *entry = chat_cache_get(pa, chat_jid);
 
-        if (conv == NULL) {
-            /* Auto-join the group chat */
-            int chat_id = g_str_hash(chat_jid);
-            conv = serv_got_joined_chat(
-                purple_account_get_connection(pa), chat_id, chat_jid);
+        if (entry->conv == NULL) {
+            /* First message since open — resolve or auto-join once */
+            entry->conv = purple_find_conversation_with_account(
+                PURPLE_CONV_TYPE_CHAT, chat_jid, pa);
+            if (entry->conv == NULL) {
+                entry->conv = serv_got_joined_chat(
+                    gc, entry->chat_id, chat_jid);
+                if (entry->conv != NULL) {
+                    /* Member list + subject from the metadata cache —
+                     * no GetGroupInfo round-trip on the hot path. */
+                    wm_groups_populate(pa, entry->conv, chat_jid);
+                }
+            }
         }
 
-        if (conv != NULL) {
+        if (entry->conv != NULL) {
             const char *display = (push_name && push_name[0]) ? push_name : sender_jid;
             serv_got_chat_in(
-                purple_account_get_connection(pa),
-                purple_conv_chat_get_id(PURPLE_CONV_CHAT(conv)),
+                gc,
+                purple_conv_chat_get_id(PURPLE_CONV_CHAT(entry->conv)),
                 display,
-                PURPLE_MESSAGE_RECV,
+                PURPLE_MESSAGE_RECV | extra_flags,
                 text,
                 (time_t)timestamp
             );
@@ -149,27 +322,336 @@ void bridge_receive_message(
         /* 1:1 message */
         const char *display = (push_name && push_name[0]) ? push_name : sender_jid;
 
-        /* Ensure the buddy exists in the list */
-        PurpleBuddy *buddy = purple_find_buddy(pa, sender_jid);
-        if (buddy == NULL) {
-            buddy = purple_buddy_new(pa, sender_jid, display);
-            purple_blist_add_buddy(buddy, NULL, NULL, NULL);
-        } else if (push_name && push_name[0]) {
-            /* Update display name if we got a push name */
-            purple_blist_alias_buddy(buddy, display);
-        }
+        /* Ensure the buddy exists; only writes the blist on changes */
+        contact_cache_seen(pa, sender_jid, push_name, display);
 
         serv_got_im(
-            purple_account_get_connection(pa),
+            gc,
             sender_jid,
             text,
-            PURPLE_MESSAGE_RECV,
+            PURPLE_MESSAGE_RECV | extra_flags,
             (time_t)timestamp
         );
     }
+
+    wm_delivery_cutoff = 0;
+
+    /* Acknowledge the message if the user opted in. Batched deliveries
+     * acknowledge once per chat in handle_messages instead. */
+    if (ack && purple_account_get_bool(pa, "send-receipts", TRUE)) {
+        gowhatsapp_go_mark_read(account, chat_jid, message_id, sender_jid);
+    }
+}
+
+static void handle_messages(
+    gowhatsapp_account_t account,
+    const bridge_message_t *msgs,
+    int count,
+    const char *arena
+) {
+    PurpleAccount *pa = (PurpleAccount *)account;
+
+    /* Delivery itself is per-message on the purple side; the win is the
+     * single CGO crossing and the single packed allocation per batch. */
+    for (int i = 0; i < count; i++) {
+        const bridge_message_t *m = &msgs[i];
+        /* Plain text takes the converter's fast path (one byte scan). */
+        char *markup = wm_format_whatsapp_to_html(arena + m->text_off);
+        deliver_message(account,
+            arena + m->sender_jid_off,
+            arena + m->chat_jid_off,
+            markup,
+            arena + m->message_id_off,
+            arena + m->push_name_off,
+            (long)m->timestamp, m->from_me, m->is_group, 0, FALSE);
+        g_free(markup);
+    }
+
+    if (!purple_account_get_bool(pa, "send-receipts", TRUE)) return;
+
+    /* Acknowledge the batch in one crossing per (chat, sender) pair
+     * rather than one per message. Batches are bounded and small, so
+     * the quadratic grouping stays in the noise. */
+    gboolean *done = g_new0(gboolean, count);
+    const char **ids = g_new(const char *, count);
+    for (int i = 0; i < count; i++) {
+        const bridge_message_t *m = &msgs[i];
+        if (done[i] || m->from_me) continue;
+        int n = 0;
+        ids[n++] = arena + m->message_id_off;
+        for (int j = i + 1; j < count; j++) {
+            const bridge_message_t *o = &msgs[j];
+            if (done[j] || o->from_me) continue;
+            if (strcmp(arena + o->chat_jid_off, arena + m->chat_jid_off) == 0 &&
+                strcmp(arena + o->sender_jid_off, arena + m->sender_jid_off) == 0) {
+                ids[n++] = arena + o->message_id_off;
+                done[j] = TRUE;
+            }
+        }
+        gowhatsapp_go_mark_read_batch(account,
+            arena + m->chat_jid_off, arena + m->sender_jid_off, ids, n);
+    }
+    g_free(done);
+    g_free(ids);
 }
 
-void bridge_presence_update(
+static void handle_media(
+    gowhatsapp_account_t account,
+    const bridge_media_t *m,
+    const char *arena
+) {
+    char *caption = wm_format_whatsapp_to_html(arena + m->caption_off);
+    const char *path = arena + m->path_off;
+    char *text;
+    PurpleMessageFlags extra = 0;
+    int img_id = 0;
+
+    if (m->data_len > 0) {
+        /* Image with inline payload — hand a copy to the purple image
+         * store and reference it from the message markup. The store
+         * takes ownership of the copy; our reference is dropped once
+         * the conversation holds its own (see qr_show_image). */
+        gpointer data = g_memdup2(arena + m->data_off, m->data_len);
+        img_id = purple_imgstore_add_with_id(data, m->data_len, NULL);
+        if (img_id > 0) {
+            text = g_strdup_printf("<img id=\"%d\">%s%s",
+                img_id, caption[0] ? "<br>" : "", caption);
+            extra = PURPLE_MESSAGE_IMAGES;
+        } else {
+            text = g_strdup_printf("[Image: %s]%s%s",
+                path, caption[0] ? " " : "", caption);
+        }
+    } else {
+        /* Non-inline media (video, document) — point at the cache file. */
+        text = g_strdup_printf("[Media saved: %s]%s%s",
+            path, caption[0] ? " " : "", caption);
+    }
+
+    deliver_message(account,
+        arena + m->sender_jid_off,
+        arena + m->chat_jid_off,
+        text,
+        arena + m->message_id_off,
+        arena + m->push_name_off,
+        (long)m->timestamp, m->from_me, m->is_group, extra, TRUE);
+
+    if (img_id > 0) {
+        purple_imgstore_unref_by_id(img_id);
+    }
+    g_free(text);
+    g_free(caption);
+}
+
+static void handle_group_meta(
+    gowhatsapp_account_t account,
+    const char *chat_jid,
+    const char *subject,
+    const bridge_participant_t *parts,
+    int count,
+    const char *arena
+) {
+    PurpleAccount *pa = (PurpleAccount *)account;
+
+    wm_groups_update(account, chat_jid, subject, parts, count, arena);
+
+    /* If the chat is open, refresh its user list and topic in place. */
+    wm_chat_entry *entry = chat_cache_get(pa, chat_jid);
+    if (entry->conv != NULL) {
+        wm_groups_populate(pa, entry->conv, chat_jid);
+    }
+}
+
+static void handle_buddy_icons(
+    gowhatsapp_account_t account,
+    const bridge_icon_t *icons,
+    int count,
+    const char *arena
+) {
+    PurpleAccount *pa = (PurpleAccount *)account;
+
+    for (int i = 0; i < count; i++) {
+        const char *jid = arena + icons[i].jid_off;
+        if (icons[i].data_len == 0) {
+            /* Avatar removed. */
+            purple_buddy_icons_set_for_user(pa, jid, NULL, 0, NULL);
+            continue;
+        }
+        /* purple takes ownership of the copy. */
+        gpointer data = g_memdup2(arena + icons[i].data_off,
+            icons[i].data_len);
+        purple_buddy_icons_set_for_user(pa, jid, data,
+            icons[i].data_len, NULL);
+    }
+}
+
+static void handle_receipts(
+    gowhatsapp_account_t account,
+    const bridge_receipt_t *rcpts,
+    int count,
+    const char *arena
+) {
+    PurpleAccount *pa = (PurpleAccount *)account;
+
+    /* Collapse the batch to the highest state per chat so a burst of
+     * receipts becomes one status line per conversation, not one per
+     * message. Per-message detail still lands in the debug log. */
+    GHashTable *latest = g_hash_table_new(g_str_hash, g_str_equal);
+    for (int i = 0; i < count; i++) {
+        const char *chat = arena + rcpts[i].chat_jid_off;
+        int prev = GPOINTER_TO_INT(g_hash_table_lookup(latest, chat));
+        if (rcpts[i].state > prev) {
+            g_hash_table_insert(latest, (gpointer)chat,
+                GINT_TO_POINTER(rcpts[i].state));
+        }
+        purple_debug_info(PLUGIN_ID, "Receipt for %s in %s: %s\n",
+            arena + rcpts[i].message_id_off, chat,
+            (rcpts[i].state >= 2) ? "read" : "delivered");
+    }
+
+    GHashTableIter iter;
+    gpointer chat_ptr, state_ptr;
+    g_hash_table_iter_init(&iter, latest);
+    while (g_hash_table_iter_next(&iter, &chat_ptr, &state_ptr)) {
+        const char *chat = chat_ptr;
+        PurpleConversation *conv = purple_find_conversation_with_account(
+            PURPLE_CONV_TYPE_IM, chat, pa);
+        if (conv == NULL) {
+            conv = purple_find_conversation_with_account(
+                PURPLE_CONV_TYPE_CHAT, chat, pa);
+        }
+        if (conv == NULL) continue;
+
+        purple_conversation_write(conv, NULL,
+            (GPOINTER_TO_INT(state_ptr) >= 2) ? "✓✓ Read" : "✓ Delivered",
+            PURPLE_MESSAGE_SYSTEM | PURPLE_MESSAGE_NO_LOG, time(NULL));
+    }
+    g_hash_table_destroy(latest);
+}
+
+static void handle_send_result(
+    gowhatsapp_account_t account,
+    uint64_t token,
+    const char *jid,
+    int status,
+    const char *server_id,
+    int64_t server_ts
+) {
+    PurpleAccount *pa = (PurpleAccount *)account;
+    (void)server_ts;
+
+    if (status == 0) {
+        purple_debug_info(PLUGIN_ID, "Send %llu to %s confirmed (id %s)\n",
+            (unsigned long long)token, jid, server_id);
+        return;
+    }
+
+    /* Surface the failure in the conversation it belongs to, if open;
+     * the Go side already reported the detailed error via bridge_error. */
+    purple_debug_error(PLUGIN_ID, "Send %llu to %s failed\n",
+        (unsigned long long)token, jid);
+
+    PurpleConversation *conv = purple_find_conversation_with_account(
+        PURPLE_CONV_TYPE_IM, jid, pa);
+    if (conv == NULL) {
+        conv = purple_find_conversation_with_account(
+            PURPLE_CONV_TYPE_CHAT, jid, pa);
+    }
+    if (conv != NULL) {
+        purple_conversation_write(conv, NULL,
+            "Message could not be sent.",
+            PURPLE_MESSAGE_ERROR, time(NULL));
+    }
+}
+
+/* Apply a full roster snapshot differentially: additions and alias
+ * changes go through contact_cache_seen (which already touches purple
+ * only on first sight or change), then one removal pass drops buddies
+ * this account carries that the contact store no longer knows. Only
+ * buddies the plugin itself created (tagged "wm-auto") are eligible —
+ * a buddy the user added by hand is theirs to delete, even if the
+ * phone's contact store has never heard of it. */
+static void handle_contact_sync(
+    gowhatsapp_account_t account,
+    const bridge_contact_t *contacts,
+    int count,
+    const char *arena
+) {
+    PurpleAccount *pa = (PurpleAccount *)account;
+    int removed = 0;
+
+    /* Index the snapshot for the removal pass; keys point into the
+     * event arena, which outlives this handler. */
+    GHashTable *snapshot = g_hash_table_new(g_str_hash, g_str_equal);
+
+    for (int i = 0; i < count; i++) {
+        const char *jid = arena + contacts[i].jid_off;
+        const char *alias = arena + contacts[i].alias_off;
+
+        g_hash_table_add(snapshot, (gpointer)jid);
+        contact_cache_seen(pa, jid, alias, alias[0] ? alias : jid);
+    }
+
+    GSList *buddies = purple_find_buddies(pa, NULL);
+    for (GSList *l = buddies; l != NULL; l = l->next) {
+        PurpleBuddy *buddy = l->data;
+        if (!purple_blist_node_get_bool((PurpleBlistNode *)buddy, "wm-auto")) {
+            continue;
+        }
+        if (!g_hash_table_contains(snapshot, purple_buddy_get_name(buddy))) {
+            purple_blist_remove_buddy(buddy);
+            removed++;
+        }
+    }
+    g_slist_free(buddies);
+    g_hash_table_destroy(snapshot);
+
+    purple_debug_info(PLUGIN_ID,
+        "Roster sync: %d contacts in one batch, %d removed\n",
+        count, removed);
+}
+
+static void handle_broadcast_results(
+    gowhatsapp_account_t account,
+    uint64_t token,
+    const bridge_broadcast_result_t *results,
+    int count,
+    const char *arena
+) {
+    PurpleAccount *pa = (PurpleAccount *)account;
+    int failed = 0;
+
+    for (int i = 0; i < count; i++) {
+        const bridge_broadcast_result_t *r = &results[i];
+        const char *jid = arena + r->jid_off;
+
+        if (r->status == 0) {
+            purple_debug_info(PLUGIN_ID,
+                "Broadcast %llu to %s confirmed (id %s)\n",
+                (unsigned long long)token, jid, arena + r->message_id_off);
+            continue;
+        }
+        failed++;
+
+        /* Surface per-recipient failures in their conversation, if open. */
+        PurpleConversation *conv = purple_find_conversation_with_account(
+            PURPLE_CONV_TYPE_IM, jid, pa);
+        if (conv == NULL) {
+            conv = purple_find_conversation_with_account(
+                PURPLE_CONV_TYPE_CHAT, jid, pa);
+        }
+        if (conv != NULL) {
+            purple_conversation_write(conv, NULL,
+                "Broadcast message could not be sent.",
+                PURPLE_MESSAGE_ERROR, time(NULL));
+        }
+    }
+
+    purple_debug_info(PLUGIN_ID,
+        "Broadcast %llu complete: %d recipients, %d failed\n",
+        (unsigned long long)token, count, failed);
+}
+
+static void handle_presence_update(
     gowhatsapp_account_t account,
     const char *jid,
     int available
@@ -182,47 +664,294 @@ void bridge_presence_update(
     }
 }
 
-void bridge_typing_notification(
+static void handle_typing_notification(
     gowhatsapp_account_t account,
     const char *jid,
     int composing
 ) {
     PurpleAccount *pa = (PurpleAccount *)account;
+    PurpleConnection *gc = purple_account_get_connection(pa);
+    if (gc == NULL) return;
+
     if (composing) {
-        serv_got_typing(purple_account_get_connection(pa), jid,
-            0, PURPLE_TYPING);
+        serv_got_typing(gc, jid, 0, PURPLE_TYPING);
     } else {
-        serv_got_typing_stopped(purple_account_get_connection(pa), jid);
+        serv_got_typing_stopped(gc, jid);
     }
 }
 
 /* ────────────────────────────────────────────────────────────────
- * libpurple protocol plugin callbacks
+ * Go → C bridge callbacks
+ *
+ * Called from whatsmeow goroutines — they must not touch libpurple.
+ * Each one copies its payload into a wm_event_t and pushes it onto the
+ * marshal queue; wm_dispatch_event() below runs on the main loop.
  * ──────────────────────────────────────────────────────────────── */
 
-static const char *wm_list_icon(PurpleAccount *account, PurpleBuddy *buddy) {
-    return "whatsapp";
+static void wm_dispatch_event(wm_event_t *ev) {
+    switch (ev->type) {
+    case WM_EV_QR_CODE:
+        handle_show_qr_code(ev->account, ev->str1);
+        break;
+    case WM_EV_CONNECTING:
+        handle_connecting(ev->account, ev->str1);
+        break;
+    case WM_EV_CONNECTED:
+        handle_connected(ev->account);
+        break;
+    case WM_EV_DISCONNECTED:
+        handle_disconnected(ev->account);
+        break;
+    case WM_EV_ERROR:
+        handle_error(ev->account, ev->str1);
+        break;
+    case WM_EV_MESSAGES:
+        handle_messages(ev->account, ev->msgs, ev->count, ev->arena);
+        break;
+    case WM_EV_MEDIA:
+        handle_media(ev->account, ev->media, ev->arena);
+        break;
+    case WM_EV_SEND_RESULT:
+        handle_send_result(ev->account, ev->u64, ev->str1, ev->i1,
+            ev->str2, ev->i64);
+        break;
+    case WM_EV_BUDDY_ICONS:
+        handle_buddy_icons(ev->account, ev->icons, ev->count, ev->arena);
+        break;
+    case WM_EV_GROUP_META:
+        handle_group_meta(ev->account, ev->str1, ev->str2, ev->parts,
+            ev->count, ev->arena);
+        break;
+    case WM_EV_RECEIPT_BATCH:
+        handle_receipts(ev->account, ev->rcpts, ev->count, ev->arena);
+        break;
+    case WM_EV_BROADCAST_RESULTS:
+        handle_broadcast_results(ev->account, ev->u64, ev->bres,
+            ev->count, ev->arena);
+        break;
+    case WM_EV_CONTACT_SYNC:
+        handle_contact_sync(ev->account, ev->contacts, ev->count, ev->arena);
+        break;
+    case WM_EV_PRESENCE_BATCH:
+        for (int i = 0; i < ev->count; i++) {
+            const bridge_presence_t *u = &ev->pres[i];
+            const char *jid = ev->arena + u->jid_off;
+            if (u->kind == 0) {
+                handle_presence_update(ev->account, jid, u->state);
+            } else {
+                handle_typing_notification(ev->account, jid, u->state);
+            }
+        }
+        break;
+    }
+}
+
+void bridge_show_qr_code(gowhatsapp_account_t account, const char *qr_data) {
+    wm_event_t *ev = wm_event_new(WM_EV_QR_CODE, account);
+    ev->str1 = g_strdup(qr_data);
+    wm_event_push(ev);
+}
+
+void bridge_connecting(gowhatsapp_account_t account, const char *stage) {
+    wm_event_t *ev = wm_event_new(WM_EV_CONNECTING, account);
+    ev->str1 = g_strdup(stage);
+    wm_event_push(ev);
+}
+
+void bridge_connected(gowhatsapp_account_t account) {
+    wm_event_push(wm_event_new(WM_EV_CONNECTED, account));
+}
+
+void bridge_disconnected(gowhatsapp_account_t account) {
+    wm_event_push(wm_event_new(WM_EV_DISCONNECTED, account));
+}
+
+void bridge_error(gowhatsapp_account_t account, const char *message) {
+    wm_event_t *ev = wm_event_new(WM_EV_ERROR, account);
+    ev->str1 = g_strdup(message);
+    wm_event_push(ev);
+}
+
+void bridge_receive_messages(
+    gowhatsapp_account_t account,
+    const bridge_message_t *msgs,
+    int count,
+    const char *arena,
+    int arena_len
+) {
+    /* Copy the packed batch (structs + arena) into one block the event
+     * owns — the Go side frees its buffer when this call returns. */
+    size_t struct_bytes = (size_t)count * sizeof(bridge_message_t);
+    char *block = g_malloc(struct_bytes + (size_t)arena_len);
+    memcpy(block, msgs, struct_bytes);
+    memcpy(block + struct_bytes, arena, (size_t)arena_len);
+
+    wm_event_t *ev = wm_event_new(WM_EV_MESSAGES, account);
+    ev->msgs = (bridge_message_t *)block;
+    ev->arena = block + struct_bytes;
+    ev->count = count;
+    wm_event_push(ev);
 }
 
-static GList *wm_status_types(PurpleAccount *account) {
-    GList *types = NULL;
-    PurpleStatusType *type;
+void bridge_receive_media(
+    gowhatsapp_account_t account,
+    const bridge_media_t *media,
+    const char *arena,
+    int arena_len
+) {
+    /* Same ownership dance as bridge_receive_messages: one block holding
+     * the struct followed by its arena (strings + payload bytes). */
+    char *block = g_malloc(sizeof(bridge_media_t) + (size_t)arena_len);
+    memcpy(block, media, sizeof(bridge_media_t));
+    memcpy(block + sizeof(bridge_media_t), arena, (size_t)arena_len);
 
-    type = purple_status_type_new_full(PURPLE_STATUS_AVAILABLE,
-        "online", "Online", TRUE, TRUE, FALSE);
-    types = g_list_append(types, type);
+    wm_event_t *ev = wm_event_new(WM_EV_MEDIA, account);
+    ev->media = (bridge_media_t *)block;
+    ev->arena = block + sizeof(bridge_media_t);
+    wm_event_push(ev);
+}
 
-    type = purple_status_type_new_full(PURPLE_STATUS_AWAY,
-        "away", "Away", TRUE, TRUE, FALSE);
-    types = g_list_append(types, type);
+void bridge_send_result(
+    gowhatsapp_account_t account,
+    uint64_t token,
+    const char *jid,
+    int status,
+    const char *server_id,
+    int64_t server_ts
+) {
+    wm_event_t *ev = wm_event_new(WM_EV_SEND_RESULT, account);
+    ev->u64 = token;
+    ev->str1 = g_strdup(jid);
+    ev->i1 = status;
+    ev->str2 = g_strdup(server_id);
+    ev->i64 = server_ts;
+    wm_event_push(ev);
+}
 
-    type = purple_status_type_new_full(PURPLE_STATUS_OFFLINE,
-        "offline", "Offline", TRUE, TRUE, FALSE);
-    types = g_list_append(types, type);
+void bridge_set_buddy_icons(
+    gowhatsapp_account_t account,
+    const bridge_icon_t *icons,
+    int count,
+    const char *arena,
+    int arena_len
+) {
+    size_t struct_bytes = (size_t)count * sizeof(bridge_icon_t);
+    char *block = g_malloc(struct_bytes + (size_t)arena_len);
+    memcpy(block, icons, struct_bytes);
+    memcpy(block + struct_bytes, arena, (size_t)arena_len);
 
-    return types;
+    wm_event_t *ev = wm_event_new(WM_EV_BUDDY_ICONS, account);
+    ev->icons = (bridge_icon_t *)block;
+    ev->arena = block + struct_bytes;
+    ev->count = count;
+    wm_event_push(ev);
 }
 
+void bridge_group_metadata(
+    gowhatsapp_account_t account,
+    const char *chat_jid,
+    const char *subject,
+    const bridge_participant_t *participants,
+    int count,
+    const char *arena,
+    int arena_len
+) {
+    size_t struct_bytes = (size_t)count * sizeof(bridge_participant_t);
+    char *block = g_malloc(struct_bytes + (size_t)arena_len);
+    memcpy(block, participants, struct_bytes);
+    memcpy(block + struct_bytes, arena, (size_t)arena_len);
+
+    wm_event_t *ev = wm_event_new(WM_EV_GROUP_META, account);
+    ev->str1 = g_strdup(chat_jid);
+    ev->str2 = g_strdup(subject);
+    ev->parts = (bridge_participant_t *)block;
+    ev->arena = block + struct_bytes;
+    ev->count = count;
+    wm_event_push(ev);
+}
+
+void bridge_message_receipts(
+    gowhatsapp_account_t account,
+    const bridge_receipt_t *receipts,
+    int count,
+    const char *arena,
+    int arena_len
+) {
+    size_t struct_bytes = (size_t)count * sizeof(bridge_receipt_t);
+    char *block = g_malloc(struct_bytes + (size_t)arena_len);
+    memcpy(block, receipts, struct_bytes);
+    memcpy(block + struct_bytes, arena, (size_t)arena_len);
+
+    wm_event_t *ev = wm_event_new(WM_EV_RECEIPT_BATCH, account);
+    ev->rcpts = (bridge_receipt_t *)block;
+    ev->arena = block + struct_bytes;
+    ev->count = count;
+    wm_event_push(ev);
+}
+
+void bridge_sync_contacts(
+    gowhatsapp_account_t account,
+    const bridge_contact_t *contacts,
+    int count,
+    const char *arena,
+    int arena_len
+) {
+    size_t struct_bytes = (size_t)count * sizeof(bridge_contact_t);
+    char *block = g_malloc(struct_bytes + (size_t)arena_len);
+    memcpy(block, contacts, struct_bytes);
+    memcpy(block + struct_bytes, arena, (size_t)arena_len);
+
+    wm_event_t *ev = wm_event_new(WM_EV_CONTACT_SYNC, account);
+    ev->contacts = (bridge_contact_t *)block;
+    ev->arena = block + struct_bytes;
+    ev->count = count;
+    wm_event_push(ev);
+}
+
+void bridge_broadcast_results(
+    gowhatsapp_account_t account,
+    uint64_t token,
+    const bridge_broadcast_result_t *results,
+    int count,
+    const char *arena,
+    int arena_len
+) {
+    size_t struct_bytes = (size_t)count * sizeof(bridge_broadcast_result_t);
+    char *block = g_malloc(struct_bytes + (size_t)arena_len);
+    memcpy(block, results, struct_bytes);
+    memcpy(block + struct_bytes, arena, (size_t)arena_len);
+
+    wm_event_t *ev = wm_event_new(WM_EV_BROADCAST_RESULTS, account);
+    ev->bres = (bridge_broadcast_result_t *)block;
+    ev->arena = block + struct_bytes;
+    ev->count = count;
+    ev->u64 = token;
+    wm_event_push(ev);
+}
+
+void bridge_presence_updates(
+    gowhatsapp_account_t account,
+    const bridge_presence_t *updates,
+    int count,
+    const char *arena,
+    int arena_len
+) {
+    size_t struct_bytes = (size_t)count * sizeof(bridge_presence_t);
+    char *block = g_malloc(struct_bytes + (size_t)arena_len);
+    memcpy(block, updates, struct_bytes);
+    memcpy(block + struct_bytes, arena, (size_t)arena_len);
+
+    wm_event_t *ev = wm_event_new(WM_EV_PRESENCE_BATCH, account);
+    ev->pres = (bridge_presence_t *)block;
+    ev->arena = block + struct_bytes;
+    ev->count = count;
+    wm_event_push(ev);
+}
+
+/* ────────────────────────────────────────────────────────────────
+ * libpurple protocol callbacks (reached via the shim's ops table)
+ * ──────────────────────────────────────────────────────────────── */
+
 static void wm_login(PurpleAccount *account) {
     PurpleConnection *gc = purple_account_get_connection(account);
     purple_connection_set_state(gc, PURPLE_CONNECTING);
@@ -231,11 +960,21 @@ static void wm_login(PurpleAccount *account) {
     char *phone = extract_phone(username);
 
     gowhatsapp_account_t handle = (gowhatsapp_account_t)account;
-    int result = gowhatsapp_go_login(handle, phone);
+    int result = gowhatsapp_go_login(handle, phone,
+        purple_account_get_bool(account, "fast-store", TRUE));
 
     g_free(phone);
 
+    if (result == 0) {
+        gowhatsapp_go_set_presence_flush(handle,
+            purple_account_get_int(account, "presence-flush-ms", 250));
+        gowhatsapp_go_set_media_auto_download(handle,
+            purple_account_get_bool(account, "auto-download-images", FALSE));
+    }
+
     if (result != 0) {
+        /* Login only fails synchronously if the account is already up;
+         * real connect errors arrive later via bridge_disconnected. */
         purple_connection_error_reason(gc,
             PURPLE_CONNECTION_ERROR_OTHER_ERROR,
             "Failed to initialize WhatsApp connection");
@@ -253,13 +992,16 @@ static int wm_send_im(PurpleConnection *gc, const char *who,
     PurpleAccount *account = purple_connection_get_account(gc);
     gowhatsapp_account_t handle = (gowhatsapp_account_t)account;
 
-    /* Strip HTML tags that Pidgin may add */
-    char *plain = purple_markup_strip_html(message);
+    /* Map Pidgin's HTML to WhatsApp markers in one pass, preserving the
+     * bold/italic the user typed; plain text is a byte scan + copy. */
+    char *converted = wm_format_html_to_whatsapp(message);
 
-    int result = gowhatsapp_go_send_message(handle, who, plain);
-    g_free(plain);
+    /* Enqueues and returns immediately — completion (or failure) arrives
+     * later via bridge_send_result, so typing never stalls on the network. */
+    uint64_t token = gowhatsapp_go_send_message(handle, who, converted);
+    g_free(converted);
 
-    return (result == 0) ? 1 : -1;
+    return (token != 0) ? 1 : -1;
 }
 
 static unsigned int wm_send_typing(PurpleConnection *gc, const char *name,
@@ -281,79 +1023,108 @@ static int wm_chat_send(PurpleConnection *gc, int id,
     const char *chat_jid = purple_conversation_get_name(conv);
     gowhatsapp_account_t handle = (gowhatsapp_account_t)account;
 
-    char *plain = purple_markup_strip_html(message);
-    int result = gowhatsapp_go_send_message(handle, chat_jid, plain);
-    g_free(plain);
+    char *converted = wm_format_html_to_whatsapp(message);
+    uint64_t token = gowhatsapp_go_send_message(handle, chat_jid, converted);
+    g_free(converted);
 
-    return (result == 0) ? 1 : -1;
+    return (token != 0) ? 1 : -1;
 }
 
 /* ────────────────────────────────────────────────────────────────
- * Plugin registration
+ * Performance statistics
+ *
+ * Counters live where the work happens — the marshal queue counts its
+ * own pushes and drains, the Go side counts everything crossing the
+ * bridge — and this just renders both. Reached from the shim's plugin
+ * action and the /wmstats conversation command.
  * ──────────────────────────────────────────────────────────────── */
 
-static PurplePluginProtocolInfo prpl_info = {
-    .options           = OPT_PROTO_NO_PASSWORD | OPT_PROTO_IM_IMAGE,
-    .list_icon         = wm_list_icon,
-    .status_types      = wm_status_types,
-    .login             = wm_login,
-    .close             = wm_close,
-    .send_im           = wm_send_im,
-    .send_typing       = wm_send_typing,
-    .chat_send         = wm_chat_send,
-    /* Fields we don't implement yet */
-    .list_emblem       = NULL,
-    .status_text       = NULL,
-    .tooltip_text      = NULL,
-    .blist_node_menu   = NULL,
-    .chat_info         = NULL,
-    .chat_info_defaults= NULL,
-    .set_chat_topic    = NULL,
-    .get_info          = NULL,
-    .set_status        = NULL,
-    .add_buddy         = NULL,
-    .remove_buddy      = NULL,
-    .join_chat         = NULL,
-    .reject_chat       = NULL,
-    .get_chat_name     = NULL,
-    .roomlist_get_list = NULL,
-    .struct_size       = sizeof(PurplePluginProtocolInfo),
-};
+static char *wm_stats_dump(void) {
+    guint64 pushed = 0, drains = 0, peak = 0;
+    wm_event_queue_stats(&pushed, &drains, &peak);
 
-static PurplePluginInfo info = {
-    .magic             = PURPLE_PLUGIN_MAGIC,
-    .major_version     = PURPLE_MAJOR_VERSION,
-    .minor_version     = PURPLE_MINOR_VERSION,
-    .type              = PURPLE_PLUGIN_PROTOCOL,
-    .priority          = PURPLE_PRIORITY_DEFAULT,
-    .id                = PLUGIN_ID,
-    .name              = PLUGIN_NAME,
-    .version           = PLUGIN_VERSION,
-    .summary           = PLUGIN_SUMMARY,
-    .description       = "WhatsApp messaging via whatsmeow. "
-                         "E2E encrypted using the Signal protocol. "
-                         "No third-party servers involved.",
-    .author            = PLUGIN_AUTHOR,
-    .homepage          = PLUGIN_URL,
-    .extra_info        = &prpl_info,
+    char *go_stats = gowhatsapp_go_get_stats();
+    char *dump = g_strdup_printf(
+        "event queue: %" G_GUINT64_FORMAT " events in %" G_GUINT64_FORMAT
+        " drains, peak batch %" G_GUINT64_FORMAT "\n%s",
+        pushed, drains, peak, go_stats);
+    free(go_stats);    /* allocated by C.CString on the Go side */
+    return dump;
+}
+
+static PurpleCmdRet wm_cmd_stats(PurpleConversation *conv, const gchar *cmd,
+                                 gchar **args, gchar **error, void *data) {
+    (void)cmd; (void)args; (void)error; (void)data;
+
+    char *dump = wm_stats_dump();
+    purple_conversation_write(conv, NULL, dump,
+        PURPLE_MESSAGE_SYSTEM | PURPLE_MESSAGE_NO_LOG, time(NULL));
+    g_free(dump);
+    return PURPLE_CMD_RET_OK;
+}
+
+/* ────────────────────────────────────────────────────────────────
+ * Core entry point
+ *
+ * The only symbol the shim resolves. Runs the one-time setup that used
+ * to live in init_plugin — now deferred until the first account
+ * actually logs in, so an installed-but-unused plugin costs nothing.
+ * ──────────────────────────────────────────────────────────────── */
+
+static const wm_core_ops_t core_ops = {
+    .login       = wm_login,
+    .close       = wm_close,
+    .send_im     = wm_send_im,
+    .send_typing = wm_send_typing,
+    .chat_send   = wm_chat_send,
+    .stats_dump  = wm_stats_dump,
 };
 
-static void init_plugin(PurplePlugin *plugin) {
-    PurpleAccountOption *option;
+const wm_core_ops_t *wm_core_init(PurplePlugin *plugin) {
+    static gboolean initialized = FALSE;
+    if (initialized) {
+        return &core_ops;
+    }
+    initialized = TRUE;
+
+    /* Cap the embedded Go runtime before anything can start it: two
+     * scheduler threads and a tight GC are plenty for a bridge that
+     * mostly waits on a WebSocket. Tunable via prefs, no rebuild. */
+    purple_prefs_add_none("/plugins/prpl/whatsmeow-lite");
+    purple_prefs_add_int("/plugins/prpl/whatsmeow-lite/max-procs", 2);
+    purple_prefs_add_int("/plugins/prpl/whatsmeow-lite/gc-percent", 50);
+    purple_prefs_add_int("/plugins/prpl/whatsmeow-lite/mem-limit-mb", 0);
+    gowhatsapp_go_configure_runtime(
+        purple_prefs_get_int("/plugins/prpl/whatsmeow-lite/max-procs"),
+        purple_prefs_get_int("/plugins/prpl/whatsmeow-lite/gc-percent"),
+        purple_prefs_get_int("/plugins/prpl/whatsmeow-lite/mem-limit-mb"));
 
-    /* Option: send read receipts */
-    option = purple_account_option_bool_new(
-        "Send read receipts", "send-receipts", TRUE);
-    prpl_info.protocol_options = g_list_append(
-        prpl_info.protocol_options, option);
+    /* Route Go→C events through the main-loop marshal queue. */
+    wm_event_queue_init(wm_dispatch_event);
 
-    /* Option: auto-download images */
-    option = purple_account_option_bool_new(
-        "Auto-download images", "auto-download-images", FALSE);
-    prpl_info.protocol_options = g_list_append(
-        prpl_info.protocol_options, option);
+    /* Chat lookup cache + invalidation when conversations close. */
+    chat_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    purple_signal_connect(purple_conversations_get_handle(),
+        "deleting-conversation", plugin,
+        PURPLE_CALLBACK(chat_cache_conv_deleting), NULL);
 
-    purple_debug_info(PLUGIN_ID, "WhatsApp (whatsmeow) plugin initialized\n");
-}
+    /* Instant backfill from the local archive when a window opens. */
+    purple_signal_connect(purple_conversations_get_handle(),
+        "conversation-created", plugin,
+        PURPLE_CALLBACK(wm_conversation_created), NULL);
 
-PURPLE_INIT_PLUGIN(whatsmeow_lite, init_plugin, info)
+    /* Contact cache + invalidation when buddies are removed. */
+    contact_cache = g_hash_table_new_full(g_str_hash, g_str_equal,
+        g_free, contact_entry_free);
+    purple_signal_connect(purple_blist_get_handle(),
+        "buddy-removed", plugin,
+        PURPLE_CALLBACK(contact_cache_buddy_removed), NULL);
+
+    /* /wmstats in any conversation dumps the performance counters. */
+    purple_cmd_register("wmstats", "", PURPLE_CMD_P_PLUGIN,
+        PURPLE_CMD_FLAG_IM | PURPLE_CMD_FLAG_CHAT, PLUGIN_ID,
+        wm_cmd_stats, "wmstats:  Show bridge performance counters", NULL);
+
+    purple_debug_info(PLUGIN_ID, "WhatsApp (whatsmeow) bridge core initialized\n");
+    return &core_ops;
+}
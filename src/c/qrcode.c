@@ -0,0 +1,151 @@
+/*
+ * qrcode.c — pairing QR code presentation.
+ *
+ * See qrcode.h. The rendered path encodes the payload with libqrencode,
+ * expands the module matrix into an RGB pixbuf (8 px per module, 4
+ * quiet-zone modules), PNG-encodes it in memory, and shows it through
+ * the purple image store + notify API. Each rotation closes the
+ * previous dialog and opens the refreshed one, so the visible code is
+ * always scannable. Main-thread only.
+ */
+
+#include <string.h>
+
+#include <purple.h>
+
+#include "qrcode.h"
+
+#define QR_PLUGIN_ID "prpl-whatsmeow-lite"
+
+#if defined(HAVE_QRENCODE) && defined(HAVE_GDK_PIXBUF)
+
+#include <qrencode.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#define QR_MODULE_PX  8     /* pixels per QR module */
+#define QR_MARGIN     4     /* quiet-zone modules on each side */
+
+/* One open QR dialog per account, so rotation replaces instead of
+ * stacking windows. Keyed by PurpleAccount pointer. */
+static GHashTable *qr_dialogs;  /* PurpleAccount* → notify ui_handle */
+
+static void qr_dialog_closed(gpointer data) {
+    if (qr_dialogs != NULL) {
+        g_hash_table_remove(qr_dialogs, data);
+    }
+}
+
+/* Render the QR payload to an in-memory PNG. Returns NULL on encode
+ * failure; the caller falls back to the text display. */
+static gpointer qr_render_png(const char *qr_data, gsize *png_len) {
+    QRcode *code = QRcode_encodeString(qr_data, 0, QR_ECLEVEL_M,
+        QR_MODE_8, 1);
+    if (code == NULL) return NULL;
+
+    int size = (code->width + 2 * QR_MARGIN) * QR_MODULE_PX;
+    GdkPixbuf *pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8,
+        size, size);
+    if (pixbuf == NULL) {
+        QRcode_free(code);
+        return NULL;
+    }
+
+    guchar *pixels = gdk_pixbuf_get_pixels(pixbuf);
+    int rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+
+    /* White background, then stamp the dark modules. */
+    for (int y = 0; y < size; y++) {
+        memset(pixels + y * rowstride, 0xff, (size_t)size * 3);
+    }
+    for (int my = 0; my < code->width; my++) {
+        for (int mx = 0; mx < code->width; mx++) {
+            if (!(code->data[my * code->width + mx] & 1)) continue;
+
+            int px = (mx + QR_MARGIN) * QR_MODULE_PX;
+            int py = (my + QR_MARGIN) * QR_MODULE_PX;
+            for (int dy = 0; dy < QR_MODULE_PX; dy++) {
+                memset(pixels + (py + dy) * rowstride + px * 3, 0x00,
+                    QR_MODULE_PX * 3);
+            }
+        }
+    }
+    QRcode_free(code);
+
+    gchar *png = NULL;
+    gboolean ok = gdk_pixbuf_save_to_buffer(pixbuf, &png, png_len,
+        "png", NULL, NULL);
+    g_object_unref(pixbuf);
+
+    return ok ? png : NULL;
+}
+
+static gboolean qr_show_image(PurpleConnection *gc, const char *qr_data) {
+    gsize png_len = 0;
+    gpointer png = qr_render_png(qr_data, &png_len);
+    if (png == NULL) return FALSE;
+
+    /* The image store takes ownership of the PNG buffer. */
+    int img_id = purple_imgstore_add_with_id(png, png_len, NULL);
+    if (img_id <= 0) {
+        g_free(png);
+        return FALSE;
+    }
+
+    char *msg = g_strdup_printf(
+        "<img id=\"%d\"><br><br>"
+        "WhatsApp → Settings → Linked Devices → Link a Device<br>"
+        "<i>The code refreshes automatically until you scan it.</i>",
+        img_id);
+
+    if (qr_dialogs == NULL) {
+        qr_dialogs = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+
+    PurpleAccount *pa = purple_connection_get_account(gc);
+    gpointer old = g_hash_table_lookup(qr_dialogs, pa);
+    if (old != NULL) {
+        /* Rotation: replace the stale code instead of stacking dialogs. */
+        g_hash_table_remove(qr_dialogs, pa);
+        purple_notify_close(PURPLE_NOTIFY_FORMATTED, old);
+    }
+
+    gpointer handle = purple_notify_formatted(gc, "WhatsApp QR Code",
+        "Scan to Link Device", NULL, msg, qr_dialog_closed, pa);
+    if (handle != NULL) {
+        g_hash_table_insert(qr_dialogs, pa, handle);
+    }
+
+    purple_imgstore_unref_by_id(img_id);
+    g_free(msg);
+    return TRUE;
+}
+
+#endif /* HAVE_QRENCODE && HAVE_GDK_PIXBUF */
+
+/* Text fallback: raw payload plus instructions for an external
+ * generator. Also used when image rendering fails at runtime. */
+static void qr_show_text(PurpleConnection *gc, const char *qr_data) {
+    char *msg = g_strdup_printf(
+        "<b>Scan this QR code with your phone:</b><br><br>"
+        "WhatsApp → Settings → Linked Devices → Link a Device<br><br>"
+        "<b>QR Code Data:</b><br>"
+        "<tt>%s</tt><br><br>"
+        "<i>Tip: Copy this string and paste it into a QR code generator, "
+        "or use the terminal QR display if running from command line.</i>",
+        qr_data
+    );
+
+    purple_notify_formatted(gc, "WhatsApp QR Code",
+        "Scan to Link Device", NULL, msg, NULL, NULL);
+    g_free(msg);
+}
+
+void wm_qr_show(PurpleConnection *gc, const char *qr_data) {
+    /* Terminal output for headless/bitlbee setups, either way. */
+    purple_debug_info(QR_PLUGIN_ID, "QR Code: %s\n", qr_data);
+
+#if defined(HAVE_QRENCODE) && defined(HAVE_GDK_PIXBUF)
+    if (qr_show_image(gc, qr_data)) return;
+#endif
+    qr_show_text(gc, qr_data);
+}
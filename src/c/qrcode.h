@@ -0,0 +1,19 @@
+/*
+ * qrcode.h — pairing QR code presentation.
+ *
+ * With libqrencode and gdk-pixbuf available (HAVE_QRENCODE +
+ * HAVE_GDK_PIXBUF) the QR payload is rendered to an in-memory PNG and
+ * shown as an image, replaced in place on each ~20 s rotation so the
+ * user scans instead of copy-pasting into an external generator.
+ * Without them we fall back to the original text display.
+ */
+#ifndef QRCODE_H
+#define QRCODE_H
+
+#include <purple.h>
+
+/* Show (or refresh) the pairing QR dialog for this connection. Must run
+ * on the purple main loop. */
+void wm_qr_show(PurpleConnection *gc, const char *qr_data);
+
+#endif /* QRCODE_H */
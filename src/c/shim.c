@@ -0,0 +1,280 @@
+/*
+ * shim.c — thin prpl registration shim.
+ *
+ * This is the library Pidgin's plugin scanner actually loads
+ * (libwhatsmeow-lite.so). It registers the protocol, its icon, status
+ * types, and account options — everything the UI needs to show the
+ * protocol in the account dialog — but contains no bridge logic and no
+ * Go runtime. The heavy core (libwhatsmeow-core.so, C bridge + Go
+ * archive) is dlopened the first time a WhatsApp account logs in, so
+ * merely having the plugin installed adds nothing to Pidgin startup.
+ *
+ * The core lives in a `whatsmeow/` subdirectory of the plugin
+ * directory, NOT in the plugin directory itself: purple's scanner
+ * dlopens (and probes) every library it finds there, which would drag
+ * the Go runtime in at startup and defeat the whole split. The scanner
+ * does not recurse. Lookup order: ~/.purple/plugins/whatsmeow/, then
+ * the system directory compiled in as WM_CORE_DIR, then the dynamic
+ * linker's default search path.
+ */
+
+#include <dlfcn.h>
+
+#include <purple.h>
+
+#include "core.h"
+
+#define PLUGIN_NAME     "WhatsApp (whatsmeow)"
+#define PLUGIN_VERSION  "0.1.0"
+#define PLUGIN_AUTHOR   "whatsapp-native project"
+#define PLUGIN_URL      "https://github.com/johnny/pidgin-whatsapp"
+#define PLUGIN_SUMMARY  "WhatsApp via whatsmeow — lightweight, E2E encrypted"
+
+#define WM_CORE_SONAME  "libwhatsmeow-core.so"
+#define WM_CORE_SUBDIR  "whatsmeow"
+
+/* Plugin handle captured at init, passed to the core for its signal
+ * connections. */
+static PurplePlugin *shim_plugin = NULL;
+
+/* Resolved once on first login; NULL until then. */
+static const wm_core_ops_t *core = NULL;
+
+/* ────────────────────────────────────────────────────────────────
+ * Lazy core loading
+ * ──────────────────────────────────────────────────────────────── */
+
+static void *core_dlopen(void) {
+    void *handle;
+
+    char *user_path = g_build_filename(purple_user_dir(), "plugins",
+        WM_CORE_SUBDIR, WM_CORE_SONAME, NULL);
+    handle = dlopen(user_path, RTLD_NOW | RTLD_LOCAL);
+    g_free(user_path);
+    if (handle != NULL) {
+        return handle;
+    }
+
+#ifdef WM_CORE_DIR
+    handle = dlopen(WM_CORE_DIR "/" WM_CORE_SONAME, RTLD_NOW | RTLD_LOCAL);
+    if (handle != NULL) {
+        return handle;
+    }
+#endif
+
+    /* Fall back to the linker's search path (LD_LIBRARY_PATH etc). */
+    return dlopen(WM_CORE_SONAME, RTLD_NOW | RTLD_LOCAL);
+}
+
+/* Load the core and fetch its ops table. Idempotent; the core stays
+ * loaded for the life of the process (the Go runtime cannot be torn
+ * down, so unloading it would never be safe anyway). */
+static gboolean core_ensure(void) {
+    if (core != NULL) {
+        return TRUE;
+    }
+
+    void *handle = core_dlopen();
+    if (handle == NULL) {
+        purple_debug_error(WM_PLUGIN_ID,
+            "Failed to load %s: %s\n", WM_CORE_SONAME, dlerror());
+        return FALSE;
+    }
+
+    wm_core_init_fn init = (wm_core_init_fn)dlsym(handle, "wm_core_init");
+    if (init == NULL) {
+        purple_debug_error(WM_PLUGIN_ID,
+            "%s has no wm_core_init: %s\n", WM_CORE_SONAME, dlerror());
+        dlclose(handle);
+        return FALSE;
+    }
+
+    core = init(shim_plugin);
+    return core != NULL;
+}
+
+/* ────────────────────────────────────────────────────────────────
+ * Delegating protocol callbacks
+ *
+ * login loads the core on demand; the rest can only be reached once a
+ * connection exists, i.e. after a successful login, but guard anyway.
+ * ──────────────────────────────────────────────────────────────── */
+
+static const char *shim_list_icon(PurpleAccount *account, PurpleBuddy *buddy) {
+    return "whatsapp";
+}
+
+static GList *shim_status_types(PurpleAccount *account) {
+    GList *types = NULL;
+    PurpleStatusType *type;
+
+    type = purple_status_type_new_full(PURPLE_STATUS_AVAILABLE,
+        "online", "Online", TRUE, TRUE, FALSE);
+    types = g_list_append(types, type);
+
+    type = purple_status_type_new_full(PURPLE_STATUS_AWAY,
+        "away", "Away", TRUE, TRUE, FALSE);
+    types = g_list_append(types, type);
+
+    type = purple_status_type_new_full(PURPLE_STATUS_OFFLINE,
+        "offline", "Offline", TRUE, TRUE, FALSE);
+    types = g_list_append(types, type);
+
+    return types;
+}
+
+static void shim_login(PurpleAccount *account) {
+    if (!core_ensure()) {
+        PurpleConnection *gc = purple_account_get_connection(account);
+        purple_connection_error_reason(gc,
+            PURPLE_CONNECTION_ERROR_OTHER_ERROR,
+            "Failed to load the WhatsApp bridge core ("
+            WM_CORE_SONAME ") — is it installed in the plugin "
+            "directory's " WM_CORE_SUBDIR "/ subdirectory?");
+        return;
+    }
+    core->login(account);
+}
+
+static void shim_close(PurpleConnection *gc) {
+    if (core != NULL) {
+        core->close(gc);
+    }
+}
+
+static int shim_send_im(PurpleConnection *gc, const char *who,
+                        const char *message, PurpleMessageFlags flags) {
+    return (core != NULL) ? core->send_im(gc, who, message, flags) : -1;
+}
+
+static unsigned int shim_send_typing(PurpleConnection *gc, const char *name,
+                                     PurpleTypingState state) {
+    return (core != NULL) ? core->send_typing(gc, name, state) : 0;
+}
+
+static int shim_chat_send(PurpleConnection *gc, int id,
+                          const char *message, PurpleMessageFlags flags) {
+    return (core != NULL) ? core->chat_send(gc, id, message, flags) : -1;
+}
+
+/* ────────────────────────────────────────────────────────────────
+ * Plugin actions
+ * ──────────────────────────────────────────────────────────────── */
+
+static void shim_action_stats(PurplePluginAction *action) {
+    (void)action;
+
+    if (core == NULL) {
+        purple_notify_formatted(shim_plugin,
+            "Bridge statistics", "Bridge statistics", NULL,
+            "The bridge core has not been loaded yet — "
+            "log in to a WhatsApp account first.", NULL, NULL);
+        return;
+    }
+
+    char *dump = core->stats_dump();
+    char *html = purple_strdup_withhtml(dump);
+    purple_notify_formatted(shim_plugin,
+        "Bridge statistics", "Bridge statistics", NULL, html, NULL, NULL);
+    g_free(html);
+    g_free(dump);
+}
+
+static GList *shim_actions(PurplePlugin *plugin, gpointer context) {
+    (void)plugin; (void)context;
+    return g_list_append(NULL,
+        purple_plugin_action_new("Bridge statistics", shim_action_stats));
+}
+
+/* ────────────────────────────────────────────────────────────────
+ * Plugin registration
+ * ──────────────────────────────────────────────────────────────── */
+
+static PurplePluginProtocolInfo prpl_info = {
+    .options           = OPT_PROTO_NO_PASSWORD | OPT_PROTO_IM_IMAGE,
+    .list_icon         = shim_list_icon,
+    .status_types      = shim_status_types,
+    .login             = shim_login,
+    .close             = shim_close,
+    .send_im           = shim_send_im,
+    .send_typing       = shim_send_typing,
+    .chat_send         = shim_chat_send,
+    /* Fields we don't implement yet */
+    .list_emblem       = NULL,
+    .status_text       = NULL,
+    .tooltip_text      = NULL,
+    .blist_node_menu   = NULL,
+    .chat_info         = NULL,
+    .chat_info_defaults= NULL,
+    .set_chat_topic    = NULL,
+    .get_info          = NULL,
+    .set_status        = NULL,
+    .add_buddy         = NULL,
+    .remove_buddy      = NULL,
+    .join_chat         = NULL,
+    .reject_chat       = NULL,
+    .get_chat_name     = NULL,
+    .roomlist_get_list = NULL,
+    .struct_size       = sizeof(PurplePluginProtocolInfo),
+};
+
+static PurplePluginInfo info = {
+    .magic             = PURPLE_PLUGIN_MAGIC,
+    .major_version     = PURPLE_MAJOR_VERSION,
+    .minor_version     = PURPLE_MINOR_VERSION,
+    .type              = PURPLE_PLUGIN_PROTOCOL,
+    .priority          = PURPLE_PRIORITY_DEFAULT,
+    .id                = WM_PLUGIN_ID,
+    .name              = PLUGIN_NAME,
+    .version           = PLUGIN_VERSION,
+    .summary           = PLUGIN_SUMMARY,
+    .description       = "WhatsApp messaging via whatsmeow. "
+                         "E2E encrypted using the Signal protocol. "
+                         "No third-party servers involved.",
+    .author            = PLUGIN_AUTHOR,
+    .homepage          = PLUGIN_URL,
+    .extra_info        = &prpl_info,
+    .actions           = shim_actions,
+};
+
+static void init_plugin(PurplePlugin *plugin) {
+    PurpleAccountOption *option;
+
+    shim_plugin = plugin;
+
+    /* Option: send read receipts */
+    option = purple_account_option_bool_new(
+        "Send read receipts", "send-receipts", TRUE);
+    prpl_info.protocol_options = g_list_append(
+        prpl_info.protocol_options, option);
+
+    /* Option: auto-download images */
+    option = purple_account_option_bool_new(
+        "Auto-download images", "auto-download-images", FALSE);
+    prpl_info.protocol_options = g_list_append(
+        prpl_info.protocol_options, option);
+
+    /* Option: tuned session store (WAL journal, busy timeout, page
+     * cache). Disable on filesystems without WAL support, e.g. NFS. */
+    option = purple_account_option_bool_new(
+        "Fast session store (WAL)", "fast-store", TRUE);
+    prpl_info.protocol_options = g_list_append(
+        prpl_info.protocol_options, option);
+
+    /* Option: archive backfill depth when a conversation opens */
+    option = purple_account_option_int_new(
+        "Messages to backfill on open", "backfill-count", 50);
+    prpl_info.protocol_options = g_list_append(
+        prpl_info.protocol_options, option);
+
+    /* Option: presence/typing coalescing interval */
+    option = purple_account_option_int_new(
+        "Presence flush interval (ms)", "presence-flush-ms", 250);
+    prpl_info.protocol_options = g_list_append(
+        prpl_info.protocol_options, option);
+
+    purple_debug_info(WM_PLUGIN_ID,
+        "WhatsApp (whatsmeow) shim registered — core loads on first login\n");
+}
+
+PURPLE_INIT_PLUGIN(whatsmeow_lite, init_plugin, info)
@@ -0,0 +1,74 @@
+// Account registry.
+//
+// Hot-path entry points (send, typing, receipts, presence) used to
+// serialize on one global sync.Mutex guarding the accounts map, so a
+// slow login on one account stalled traffic on every other account in a
+// multi-account gateway. The registry is now read-mostly copy-on-write:
+// lookups are a single atomic load with no lock, and the mutex is only
+// taken by login/logout to publish a fresh copy of the map.
+package main
+
+import (
+	"sync"
+	"sync/atomic"
+)
+
+// accountRegistry maps PurpleAccount pointers to their bridge state.
+type accountRegistry struct {
+	mu sync.Mutex   // serializes writers (account creation/teardown)
+	m  atomic.Value // holds map[uintptr]*accountState, replaced wholesale
+}
+
+func newAccountRegistry() *accountRegistry {
+	r := &accountRegistry{}
+	r.m.Store(make(map[uintptr]*accountState))
+	return r
+}
+
+// lookup resolves an account without locking. Safe from any goroutine.
+func (r *accountRegistry) lookup(key uintptr) *accountState {
+	return r.m.Load().(map[uintptr]*accountState)[key]
+}
+
+// insert publishes a new account. Returns false if the key is taken.
+func (r *accountRegistry) insert(key uintptr, state *accountState) bool {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+
+	old := r.m.Load().(map[uintptr]*accountState)
+	if _, exists := old[key]; exists {
+		return false
+	}
+
+	next := make(map[uintptr]*accountState, len(old)+1)
+	for k, v := range old {
+		next[k] = v
+	}
+	next[key] = state
+	r.m.Store(next)
+	return true
+}
+
+// remove unpublishes an account and returns its state, or nil.
+func (r *accountRegistry) remove(key uintptr) *accountState {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+
+	old := r.m.Load().(map[uintptr]*accountState)
+	state, exists := old[key]
+	if !exists {
+		return nil
+	}
+
+	next := make(map[uintptr]*accountState, len(old)-1)
+	for k, v := range old {
+		if k != key {
+			next[k] = v
+		}
+	}
+	r.m.Store(next)
+	return state
+}
+
+// registry is the process-wide account table.
+var registry = newAccountRegistry()
@@ -0,0 +1,188 @@
+// Incoming receipt tracking for sent messages.
+//
+// events.Receipt used to be ignored, so users had no sent/delivered/read
+// indication at all. Receipts are now correlated against a bounded index
+// of recently sent message IDs, coalesced per chat+message (a read
+// supersedes a delivered), and flushed to C in batches through
+// bridge_message_receipts — one CGO crossing per window, not per
+// receipt.
+package main
+
+/*
+#include "bridge.h"
+#include <stdlib.h>
+*/
+import "C"
+
+import (
+	"sync"
+	"time"
+	"unsafe"
+
+	"go.mau.fi/whatsmeow/types"
+	"go.mau.fi/whatsmeow/types/events"
+)
+
+const (
+	// Receipt states crossing the bridge, mirroring bridge_receipt_t.
+	receiptStateDelivered = 1
+	receiptStateRead      = 2
+
+	// sentIndexCap bounds how many sent message IDs are remembered for
+	// receipt correlation. Old entries age out FIFO; a receipt for an
+	// aged-out send is simply not surfaced.
+	sentIndexCap = 512
+
+	// ackFlushWindow is how long incoming receipts coalesce before one
+	// batched crossing.
+	ackFlushWindow = 500 * time.Millisecond
+)
+
+// sentIndex remembers recently sent message IDs in FIFO order with O(1)
+// membership checks. Writer is the send worker; readers are the dispatch
+// workers handling receipts.
+type sentIndex struct {
+	mu    sync.Mutex
+	ids   map[types.MessageID]struct{}
+	order []types.MessageID
+	next  int
+}
+
+func newSentIndex() *sentIndex {
+	return &sentIndex{
+		ids:   make(map[types.MessageID]struct{}, sentIndexCap),
+		order: make([]types.MessageID, sentIndexCap),
+	}
+}
+
+// record remembers one sent message ID, evicting the oldest entry once
+// the index is full.
+func (s *sentIndex) record(id types.MessageID) {
+	s.mu.Lock()
+	if old := s.order[s.next]; old != "" {
+		delete(s.ids, old)
+	}
+	s.order[s.next] = id
+	s.next = (s.next + 1) % sentIndexCap
+	s.ids[id] = struct{}{}
+	s.mu.Unlock()
+}
+
+func (s *sentIndex) knows(id types.MessageID) bool {
+	s.mu.Lock()
+	_, ok := s.ids[id]
+	s.mu.Unlock()
+	return ok
+}
+
+// ackKey identifies one sent message awaiting a state update.
+type ackKey struct {
+	chat string
+	id   types.MessageID
+}
+
+// ackBatcher accumulates the highest receipt state per sent message
+// between flushes.
+type ackBatcher struct {
+	mu      sync.Mutex
+	pending map[ackKey]int32
+}
+
+func newAckBatcher() *ackBatcher {
+	return &ackBatcher{pending: make(map[ackKey]int32)}
+}
+
+// record folds one receipt event into the pending map. Receipts for
+// messages we did not send (or no longer remember) are dropped.
+func (a *ackBatcher) record(state *accountState, v *events.Receipt) {
+	var st int32
+	switch v.Type {
+	case types.ReceiptTypeDelivered:
+		st = receiptStateDelivered
+	case types.ReceiptTypeRead, types.ReceiptTypeReadSelf, types.ReceiptTypePlayed:
+		st = receiptStateRead
+	default:
+		return
+	}
+
+	chat := v.Chat.String()
+	a.mu.Lock()
+	for _, id := range v.MessageIDs {
+		if !state.sent.knows(id) {
+			continue
+		}
+		key := ackKey{chat: chat, id: id}
+		if st > a.pending[key] {
+			a.pending[key] = st
+		}
+	}
+	a.mu.Unlock()
+}
+
+// take swaps out and returns the pending transitions (nil when idle).
+func (a *ackBatcher) take() map[ackKey]int32 {
+	a.mu.Lock()
+	defer a.mu.Unlock()
+	if len(a.pending) == 0 {
+		return nil
+	}
+	out := a.pending
+	a.pending = make(map[ackKey]int32)
+	return out
+}
+
+// runAckFlusher delivers coalesced receipt transitions once per window.
+func runAckFlusher(account C.gowhatsapp_account_t, state *accountState) {
+	ticker := time.NewTicker(ackFlushWindow)
+	defer ticker.Stop()
+
+	for {
+		select {
+		case <-ticker.C:
+			if pending := state.acks.take(); pending != nil {
+				deliverAckBatch(account, pending)
+			}
+		case <-state.ctx.Done():
+			return
+		}
+	}
+}
+
+// deliverAckBatch packs the transitions into one arena allocation and
+// crosses once, mirroring deliverPresenceBatch.
+func deliverAckBatch(account C.gowhatsapp_account_t, pending map[ackKey]int32) {
+	count := len(pending)
+	structBytes := count * C.sizeof_bridge_receipt_t
+	arenaBytes := 0
+	for k := range pending {
+		arenaBytes += len(k.chat) + len(k.id) + 2
+	}
+
+	base := C.malloc(C.size_t(structBytes + arenaBytes))
+	entries := unsafe.Slice((*C.bridge_receipt_t)(base), count)
+	arenaPtr := unsafe.Add(base, structBytes)
+	arena := unsafe.Slice((*byte)(arenaPtr), arenaBytes)
+
+	pos := 0
+	put := func(s string) C.uint32_t {
+		off := pos
+		copy(arena[pos:], s)
+		pos += len(s)
+		arena[pos] = 0
+		pos++
+		return C.uint32_t(off)
+	}
+
+	i := 0
+	for k, st := range pending {
+		entries[i].chat_jid_off = put(k.chat)
+		entries[i].message_id_off = put(string(k.id))
+		entries[i].state = C.int32_t(st)
+		i++
+	}
+
+	C.bridge_message_receipts(account, (*C.bridge_receipt_t)(base),
+		C.int(count), (*C.char)(arenaPtr), C.int(arenaBytes))
+
+	C.free(base)
+}
@@ -0,0 +1,100 @@
+// Local message archive.
+//
+// Every message the bridge delivers or sends is appended to a compact
+// per-chat binary archive under ~/.purple/whatsmeow/archive/<phone>/,
+// next to the session DB. The C side memory-maps these files to backfill
+// a conversation window the moment it opens — one mapped read instead of
+// purple's HTML log parse. The history sync engine writes the same
+// format, so a fresh pairing seeds the archive too.
+//
+// On-disk format (little-endian, mirrored in src/c/archive.h):
+//
+//	<jid>.dat — records, each:
+//	    uint32  len      payload bytes after this field
+//	    int64   ts       unix seconds
+//	    uint8   flags    bit 0: from_me
+//	    sender  NUL-terminated
+//	    text    NUL-terminated
+//	<jid>.idx — one uint64 per record: byte offset of its len field
+//	            in the .dat file. Fixed-width, so "last N messages"
+//	            is a seek, not a scan.
+package main
+
+import (
+	"bytes"
+	"encoding/binary"
+	"io"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync"
+)
+
+// messageArchive appends records for one account. A single mutex keeps
+// the .dat/.idx pair consistent across the per-chat dispatch workers,
+// the send worker, and history ingestion.
+type messageArchive struct {
+	mu  sync.Mutex
+	dir string // empty when archiving is disabled
+}
+
+func newMessageArchive(dir string) *messageArchive {
+	if err := os.MkdirAll(dir, 0700); err != nil {
+		dir = ""
+	}
+	return &messageArchive{dir: dir}
+}
+
+// append records one message. Best effort: archive failures must never
+// stall delivery or sending.
+func (a *messageArchive) append(chatJID string, msg incomingMessage) {
+	if a.dir == "" {
+		return
+	}
+
+	var payload bytes.Buffer
+	binary.Write(&payload, binary.LittleEndian, msg.timestamp)
+	var flags uint8
+	if msg.fromMe {
+		flags |= 1
+	}
+	payload.WriteByte(flags)
+	payload.WriteString(msg.senderJID)
+	payload.WriteByte(0)
+	payload.WriteString(msg.text)
+	payload.WriteByte(0)
+
+	var record bytes.Buffer
+	binary.Write(&record, binary.LittleEndian, uint32(payload.Len()))
+	payload.WriteTo(&record)
+
+	base := filepath.Join(a.dir, archiveFileName(chatJID))
+
+	a.mu.Lock()
+	defer a.mu.Unlock()
+
+	dat, err := os.OpenFile(base+".dat", os.O_CREATE|os.O_WRONLY|os.O_APPEND, 0600)
+	if err != nil {
+		return
+	}
+	defer dat.Close()
+	offset, err := dat.Seek(0, io.SeekEnd)
+	if err != nil {
+		return
+	}
+	if _, err := dat.Write(record.Bytes()); err != nil {
+		return
+	}
+
+	idx, err := os.OpenFile(base+".idx", os.O_CREATE|os.O_WRONLY|os.O_APPEND, 0600)
+	if err != nil {
+		return
+	}
+	defer idx.Close()
+	binary.Write(idx, binary.LittleEndian, uint64(offset))
+}
+
+// archiveFileName maps a chat JID to a safe filename stem.
+func archiveFileName(chatJID string) string {
+	return strings.ReplaceAll(chatJID, string(os.PathSeparator), "_")
+}
@@ -0,0 +1,265 @@
+// Avatar prefetch pipeline.
+//
+// Profile pictures were never fetched. After events.Connected the
+// engine sweeps the contact store through a small, paced worker pool
+// (a burst of hundreds of buddies must not hammer the connection),
+// asks the server for picture info with the last-known picture ID so
+// unchanged avatars return immediately with no image transfer, and
+// keeps the image bytes in a per-account disk cache keyed by JID +
+// picture ID. Icons cross to libpurple in batches through
+// bridge_set_buddy_icons; live changes (events.Picture) reuse the same
+// path one icon at a time.
+package main
+
+/*
+#include "bridge.h"
+#include <stdlib.h>
+*/
+import "C"
+
+import (
+	"encoding/json"
+	"io"
+	"net/http"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync"
+	"time"
+	"unsafe"
+
+	"go.mau.fi/whatsmeow"
+	"go.mau.fi/whatsmeow/types"
+	"go.mau.fi/whatsmeow/types/events"
+)
+
+const (
+	// avatarWorkers bounds concurrent picture-info/image fetches.
+	avatarWorkers = 2
+	// avatarPace spaces out requests during the post-connect sweep.
+	avatarPace = 150 * time.Millisecond
+	// avatarBatchMax bounds how many icons cross in one CGO call.
+	avatarBatchMax = 16
+	// avatarBatchWindow flushes a partial icon batch after this long.
+	avatarBatchWindow = 500 * time.Millisecond
+)
+
+// avatarIcon is one fetched icon ready to cross the bridge. Empty data
+// means the avatar was removed.
+type avatarIcon struct {
+	jid  string
+	data []byte
+}
+
+// avatarEngine is the per-account fetch state and disk cache.
+type avatarEngine struct {
+	mu        sync.Mutex
+	dir       string
+	indexPath string
+	index     map[string]string // JID → picture ID on disk
+}
+
+func newAvatarEngine(dir string) *avatarEngine {
+	os.MkdirAll(dir, 0700)
+	a := &avatarEngine{
+		dir:       dir,
+		indexPath: filepath.Join(dir, "index.json"),
+		index:     make(map[string]string),
+	}
+	if data, err := os.ReadFile(a.indexPath); err == nil {
+		json.Unmarshal(data, &a.index)
+	}
+	return a
+}
+
+// cachedID returns the picture ID whose image is on disk for a JID.
+func (a *avatarEngine) cachedID(jid string) string {
+	a.mu.Lock()
+	defer a.mu.Unlock()
+	return a.index[jid]
+}
+
+// remember records a fetched picture ID and persists the index.
+func (a *avatarEngine) remember(jid, id string) {
+	a.mu.Lock()
+	a.index[jid] = id
+	if data, err := json.Marshal(a.index); err == nil {
+		os.WriteFile(a.indexPath, data, 0600)
+	}
+	a.mu.Unlock()
+}
+
+// imagePath is where a JID's current avatar image lives on disk.
+func (a *avatarEngine) imagePath(jid string) string {
+	safe := strings.ReplaceAll(jid, string(os.PathSeparator), "_")
+	return filepath.Join(a.dir, safe+".jpg")
+}
+
+// fetch resolves one contact's avatar: cache hit when the server
+// reports our picture ID is still current, download otherwise. ok is
+// false when there is nothing to deliver (no avatar, errors).
+func (a *avatarEngine) fetch(state *accountState, jid types.JID) (avatarIcon, bool) {
+	jidStr := jid.String()
+	existing := a.cachedID(jidStr)
+
+	info, err := state.client.GetProfilePictureInfo(state.ctx, jid,
+		&whatsmeow.GetProfilePictureInfoParams{ExistingID: existing})
+	if err != nil {
+		return avatarIcon{}, false
+	}
+	if info == nil {
+		// Unchanged since our cached copy — zero network for the image.
+		data, err := os.ReadFile(a.imagePath(jidStr))
+		if err != nil {
+			return avatarIcon{}, false
+		}
+		return avatarIcon{jid: jidStr, data: data}, true
+	}
+
+	req, err := http.NewRequestWithContext(state.ctx, http.MethodGet, info.URL, nil)
+	if err != nil {
+		return avatarIcon{}, false
+	}
+	resp, err := http.DefaultClient.Do(req)
+	if err != nil {
+		return avatarIcon{}, false
+	}
+	data, err := io.ReadAll(resp.Body)
+	resp.Body.Close()
+	if err != nil || resp.StatusCode != http.StatusOK {
+		return avatarIcon{}, false
+	}
+
+	os.WriteFile(a.imagePath(jidStr), data, 0600)
+	a.remember(jidStr, info.ID)
+	return avatarIcon{jid: jidStr, data: data}, true
+}
+
+// prefetchAvatars sweeps the contact store after connect: paced fetches
+// across a small pool, results batched across the bridge.
+func prefetchAvatars(account C.gowhatsapp_account_t, state *accountState) {
+	contacts, err := state.client.Store.Contacts.GetAllContacts(state.ctx)
+	if err != nil {
+		return
+	}
+
+	jobs := make(chan types.JID)
+	results := make(chan avatarIcon, avatarBatchMax)
+
+	var workers sync.WaitGroup
+	workers.Add(avatarWorkers)
+	for i := 0; i < avatarWorkers; i++ {
+		go func() {
+			defer workers.Done()
+			for jid := range jobs {
+				if icon, ok := state.avatars.fetch(state, jid); ok {
+					select {
+					case results <- icon:
+					case <-state.ctx.Done():
+						return
+					}
+				}
+			}
+		}()
+	}
+
+	// Feeder: paced so the sweep trickles instead of bursting.
+	go func() {
+		ticker := time.NewTicker(avatarPace)
+		defer ticker.Stop()
+		defer close(jobs)
+		for jid := range contacts {
+			select {
+			case <-ticker.C:
+			case <-state.ctx.Done():
+				return
+			}
+			select {
+			case jobs <- jid:
+			case <-state.ctx.Done():
+				return
+			}
+		}
+	}()
+
+	go func() {
+		workers.Wait()
+		close(results)
+	}()
+
+	// Collector: batch completed icons for the crossing.
+	batch := make([]avatarIcon, 0, avatarBatchMax)
+	flush := func() {
+		if len(batch) > 0 {
+			deliverAvatarBatch(account, batch)
+			batch = batch[:0]
+		}
+	}
+	timer := time.NewTimer(avatarBatchWindow)
+	defer timer.Stop()
+	for {
+		select {
+		case icon, ok := <-results:
+			if !ok {
+				flush()
+				return
+			}
+			batch = append(batch, icon)
+			if len(batch) == avatarBatchMax {
+				flush()
+			}
+		case <-timer.C:
+			flush()
+			timer.Reset(avatarBatchWindow)
+		case <-state.ctx.Done():
+			return
+		}
+	}
+}
+
+// handlePicture reacts to a live avatar change for one contact.
+func handlePicture(account C.gowhatsapp_account_t, state *accountState, v *events.Picture) {
+	if v.Remove {
+		state.avatars.remember(v.JID.String(), "")
+		deliverAvatarBatch(account, []avatarIcon{{jid: v.JID.String()}})
+		return
+	}
+	if icon, ok := state.avatars.fetch(state, v.JID); ok {
+		deliverAvatarBatch(account, []avatarIcon{icon})
+	}
+}
+
+// deliverAvatarBatch packs icons (structs + JID strings + image bytes)
+// into one allocation and crosses once.
+func deliverAvatarBatch(account C.gowhatsapp_account_t, batch []avatarIcon) {
+	count := len(batch)
+	structBytes := count * C.sizeof_bridge_icon_t
+	arenaBytes := 0
+	for _, icon := range batch {
+		arenaBytes += len(icon.jid) + 1 + len(icon.data)
+	}
+
+	base := C.malloc(C.size_t(structBytes + arenaBytes))
+	icons := unsafe.Slice((*C.bridge_icon_t)(base), count)
+	arenaPtr := unsafe.Add(base, structBytes)
+	arena := unsafe.Slice((*byte)(arenaPtr), arenaBytes)
+
+	pos := 0
+	for i, icon := range batch {
+		icons[i].jid_off = C.uint32_t(pos)
+		copy(arena[pos:], icon.jid)
+		pos += len(icon.jid)
+		arena[pos] = 0
+		pos++
+
+		icons[i].data_off = C.uint32_t(pos)
+		icons[i].data_len = C.uint32_t(len(icon.data))
+		copy(arena[pos:], icon.data)
+		pos += len(icon.data)
+	}
+
+	C.bridge_set_buddy_icons(account, (*C.bridge_icon_t)(base),
+		C.int(count), (*C.char)(arenaPtr), C.int(pos))
+
+	C.free(base)
+}
@@ -29,6 +29,11 @@ typedef uintptr_t gowhatsapp_account_t;
 /* Show QR code to user for pairing. `qr_data` is the raw QR string. */
 void bridge_show_qr_code(gowhatsapp_account_t account, const char *qr_data);
 
+/* Report login progress. `stage` is a short human-readable description
+ * (e.g. "Opening session store"); emitted while the asynchronous login
+ * worker advances so the UI can show per-account progress. */
+void bridge_connecting(gowhatsapp_account_t account, const char *stage);
+
 /* Notify that connection is established (QR scanned or session resumed). */
 void bridge_connected(gowhatsapp_account_t account);
 
@@ -38,50 +43,282 @@ void bridge_disconnected(gowhatsapp_account_t account);
 /* Report an error message to the user. */
 void bridge_error(gowhatsapp_account_t account, const char *message);
 
-/* Deliver a received message to the purple conversation window. */
-void bridge_receive_message(
+/* A single received message, as used by the batch delivery API below.
+ *
+ * String fields are byte offsets into the batch's shared arena buffer;
+ * each string is NUL-terminated in place, so `arena + off` is a plain C
+ * string. Packing everything into one contiguous block means the Go side
+ * does a single allocation per batch (structs + strings together) and
+ * the C side walks one cache-friendly buffer instead of chasing five
+ * heap pointers per message. */
+typedef struct {
+    uint32_t sender_jid_off;
+    uint32_t chat_jid_off;
+    uint32_t text_off;
+    uint32_t message_id_off;
+    uint32_t push_name_off;
+    int64_t timestamp;
+    int32_t from_me;
+    int32_t is_group;
+} bridge_message_t;
+
+/* Deliver a batch of received messages in one crossing. The Go side
+ * coalesces bursts (e.g. backfill after session resume) so throughput
+ * scales with batch size rather than CGO call count. `arena` holds the
+ * string data the structs' offsets refer to. The batch (structs and
+ * arena) is owned by the caller and only valid for the duration of the
+ * call. */
+void bridge_receive_messages(
+    gowhatsapp_account_t account,
+    const bridge_message_t *msgs,
+    int count,
+    const char *arena,
+    int arena_len
+);
+
+/* A downloaded media message. String fields are offsets into the call's
+ * arena, as in bridge_message_t; for images the raw payload bytes are in
+ * the arena too (data_len > 0) so the C side can hand them straight to
+ * the purple image store for inline display. Other media types are
+ * referenced by their cache path only. */
+typedef struct {
+    uint32_t chat_jid_off;
+    uint32_t sender_jid_off;
+    uint32_t push_name_off;
+    uint32_t message_id_off;
+    uint32_t caption_off;
+    uint32_t path_off;      /* content-addressed cache file */
+    uint32_t mimetype_off;
+    uint32_t data_off;      /* payload bytes (images only) */
+    uint32_t data_len;      /* 0 when no inline payload */
+    int64_t timestamp;
+    int32_t from_me;
+    int32_t is_group;
+} bridge_media_t;
+
+/* Deliver one downloaded media message. Arena memory is only valid for
+ * the duration of the call. */
+void bridge_receive_media(
+    gowhatsapp_account_t account,
+    const bridge_media_t *media,
+    const char *arena,
+    int arena_len
+);
+
+/* One coalesced presence or typing update. `jid_off` is an offset into
+ * the batch arena, as in bridge_message_t. */
+typedef struct {
+    uint32_t jid_off;
+    int32_t kind;   /* 0 = presence (state: 1 online / 0 offline),
+                       1 = typing   (state: 1 composing / 0 stopped) */
+    int32_t state;
+} bridge_presence_t;
+
+/* Deliver a batch of coalesced presence/typing updates. The Go side
+ * buffers updates per contact and keeps only the latest state, flushing
+ * on an interval — N rapid events for one contact become one entry.
+ * Batch memory is only valid for the duration of the call. */
+void bridge_presence_updates(
+    gowhatsapp_account_t account,
+    const bridge_presence_t *updates,
+    int count,
+    const char *arena,
+    int arena_len
+);
+
+/* One buddy icon, as used by bridge_set_buddy_icons. `jid_off` points
+ * at a NUL-terminated JID in the arena; the raw image bytes follow at
+ * `data_off`. data_len == 0 means the contact removed their avatar. */
+typedef struct {
+    uint32_t jid_off;
+    uint32_t data_off;
+    uint32_t data_len;
+} bridge_icon_t;
+
+/* Deliver a batch of fetched buddy icons. The Go side paces fetches and
+ * serves unchanged avatars from its disk cache, so repeat logins push
+ * icons without any image transfer. Arena memory is only valid for the
+ * duration of the call. */
+void bridge_set_buddy_icons(
+    gowhatsapp_account_t account,
+    const bridge_icon_t *icons,
+    int count,
+    const char *arena,
+    int arena_len
+);
+
+/* One group participant, as used by bridge_group_metadata. `jid_off` is
+ * an offset into the call's arena, as in bridge_message_t. */
+typedef struct {
+    uint32_t jid_off;
+    int32_t is_admin;
+} bridge_participant_t;
+
+/* Deliver one group's metadata (subject + participant list). Sent for
+ * every cached group at login, for changed groups after the batched
+ * post-connect refresh, and on incremental group-change events. The C
+ * side caches this and populates chat user lists from it — no network
+ * on the open/delivery path. Arena and strings are only valid for the
+ * duration of the call. */
+void bridge_group_metadata(
     gowhatsapp_account_t account,
-    const char *sender_jid,
     const char *chat_jid,
-    const char *text,
-    const char *message_id,
-    const char *push_name,
-    long timestamp,
-    int from_me,
-    int is_group
+    const char *subject,
+    const bridge_participant_t *participants,
+    int count,
+    const char *arena,
+    int arena_len
 );
 
-/* Update buddy presence (online/offline). */
-void bridge_presence_update(
+/* One sent-message state transition, correlated from an incoming
+ * events.Receipt. String fields are offsets into the batch arena, as in
+ * bridge_message_t. */
+typedef struct {
+    uint32_t chat_jid_off;
+    uint32_t message_id_off;
+    int32_t state;  /* 1 = delivered, 2 = read */
+} bridge_receipt_t;
+
+/* Deliver a batch of coalesced receipt transitions for messages this
+ * account sent. The Go side keeps only the highest state per message
+ * within the flush window (read supersedes delivered). Batch memory is
+ * only valid for the duration of the call. */
+void bridge_message_receipts(
     gowhatsapp_account_t account,
-    const char *jid,
-    int available  /* 1 = online, 0 = offline */
+    const bridge_receipt_t *receipts,
+    int count,
+    const char *arena,
+    int arena_len
 );
 
-/* Notify typing status for a contact. */
-void bridge_typing_notification(
+/* One roster contact, as used by bridge_sync_contacts. `alias_off`
+ * points at the preferred display name, which may be empty. Offsets are
+ * into the call's arena, as in bridge_message_t. */
+typedef struct {
+    uint32_t jid_off;
+    uint32_t alias_off;
+} bridge_contact_t;
+
+/* Deliver the full contact-store roster in one crossing, sent once
+ * after each connect. The C side diffs the snapshot against the purple
+ * buddy list and applies only additions, alias changes, and removals —
+ * connect-time population is one batch, not one mutation per contact.
+ * Batch memory is only valid for the duration of the call. */
+void bridge_sync_contacts(
     gowhatsapp_account_t account,
+    const bridge_contact_t *contacts,
+    int count,
+    const char *arena,
+    int arena_len
+);
+
+/* One per-recipient outcome of a broadcast send, as used by
+ * bridge_broadcast_results. String fields are offsets into the batch
+ * arena, as in bridge_message_t. */
+typedef struct {
+    uint32_t jid_off;
+    uint32_t message_id_off; /* server-assigned id; empty on failure */
+    int32_t status;          /* 0 = accepted, nonzero = failed */
+} bridge_broadcast_result_t;
+
+/* Report all outcomes of one gowhatsapp_go_send_broadcast call in a
+ * single crossing, made after the last recipient's send completes.
+ * `token` is the correlation token the broadcast call returned. Batch
+ * memory is only valid for the duration of the call. */
+void bridge_broadcast_results(
+    gowhatsapp_account_t account,
+    uint64_t token,
+    const bridge_broadcast_result_t *results,
+    int count,
+    const char *arena,
+    int arena_len
+);
+
+/* Report completion of an asynchronous send. `token` is the correlation
+ * token returned by gowhatsapp_go_send_message. status 0 = accepted by
+ * the server (`server_id`/`server_ts` are the server-assigned message id
+ * and timestamp); nonzero = the send failed. */
+void bridge_send_result(
+    gowhatsapp_account_t account,
+    uint64_t token,
     const char *jid,
-    int composing  /* 1 = typing, 0 = stopped */
+    int status,
+    const char *server_id,
+    int64_t server_ts
 );
 
 /* ────────────────────────────────────────────────────────────────
  * C → Go functions (implemented in whatsmeow_bridge.go via CGO export)
  * ──────────────────────────────────────────────────────────────── */
 
-/* Initiate WhatsApp login. Phone format: "6512345678" (no @s.whatsapp.net). */
-int gowhatsapp_go_login(gowhatsapp_account_t account, const char *phone);
+/* Initiate WhatsApp login. Phone format: "6512345678" (no @s.whatsapp.net).
+ * Returns immediately after enqueueing — store open and connect run on a
+ * per-account goroutine, with progress reported via bridge_connecting and
+ * completion via bridge_connected / bridge_disconnected. A nonzero return
+ * means the account is already logged in.
+ * `fast_store` != 0 opens the session DB in tuned mode (WAL journaling,
+ * busy timeout, enlarged per-connection page cache) — recommended
+ * except on filesystems where WAL is unsupported, e.g. NFS homes. */
+int gowhatsapp_go_login(gowhatsapp_account_t account, const char *phone, int fast_store);
 
 /* Disconnect and clean up. */
 void gowhatsapp_go_logout(gowhatsapp_account_t account);
 
-/* Send a text message to the given JID. Returns 0 on success. */
-int gowhatsapp_go_send_message(
+/* Tune the embedded Go runtime's footprint. `max_procs` caps scheduler
+ * threads (GOMAXPROCS), `gc_percent` tightens GC heap headroom
+ * (SetGCPercent), `mem_limit_mb` sets a soft heap limit in MiB
+ * (SetMemoryLimit). Values <= 0 leave the respective default alone.
+ * Called once from plugin init, before any account connects. */
+void gowhatsapp_go_configure_runtime(
+    int max_procs,
+    int gc_percent,
+    int mem_limit_mb
+);
+
+/* Enqueue a text message to the given JID on the per-account ordered
+ * send queue and return immediately — the network round-trip happens on
+ * a dedicated goroutine so the purple main loop never blocks on a send.
+ * Returns a correlation token (> 0) that bridge_send_result will report
+ * against, or 0 if the account is not connected or the queue is full. */
+uint64_t gowhatsapp_go_send_message(
     gowhatsapp_account_t account,
     const char *jid,
     const char *text
 );
 
+/* Send the same text to several recipients. The message is constructed
+ * once and fanned out across a small bounded pool of concurrent sends;
+ * per-recipient outcomes arrive in one bridge_broadcast_results batch
+ * when the last send completes. Returns a correlation token (> 0), or
+ * 0 if the account is not connected or `count` is empty. The jids
+ * array is only read for the duration of the call. */
+uint64_t gowhatsapp_go_send_broadcast(
+    gowhatsapp_account_t account,
+    const char **jids,
+    int count,
+    const char *text
+);
+
+/* Enable or disable automatic media download for an account (wired to
+ * the auto-download-images account option). */
+void gowhatsapp_go_set_media_auto_download(
+    gowhatsapp_account_t account,
+    int enabled
+);
+
+/* Set the presence/typing coalescing flush interval in milliseconds.
+ * 0 restores the default (250 ms). */
+void gowhatsapp_go_set_presence_flush(
+    gowhatsapp_account_t account,
+    int interval_ms
+);
+
+/* Render the bridge's performance counters (messages in/out, send
+ * round-trip histogram, receipt/presence volumes, session store open
+ * latency) as human-readable text. The returned string is allocated
+ * with malloc; the caller frees it with free(). */
+char *gowhatsapp_go_get_stats(void);
+
 /* Send typing notification. typing=1 for composing, 0 for stopped. */
 void gowhatsapp_go_send_typing(
     gowhatsapp_account_t account,
@@ -89,7 +326,10 @@ void gowhatsapp_go_send_typing(
     int typing
 );
 
-/* Mark a message as read. */
+/* Mark a message as read. Receipts are not sent immediately: they are
+ * accumulated per chat for a short window (~500 ms) and merged into one
+ * protocol send, so acknowledging a backlog costs one round-trip per
+ * chat instead of one per message. */
 void gowhatsapp_go_mark_read(
     gowhatsapp_account_t account,
     const char *jid,
@@ -97,6 +337,16 @@ void gowhatsapp_go_mark_read(
     const char *sender_jid
 );
 
+/* Mark a batch of messages in one chat as read in a single call. Shares
+ * the accumulation window with gowhatsapp_go_mark_read. */
+void gowhatsapp_go_mark_read_batch(
+    gowhatsapp_account_t account,
+    const char *jid,
+    const char *sender_jid,
+    const char **message_ids,
+    int count
+);
+
 #ifdef __cplusplus
 }
 #endif
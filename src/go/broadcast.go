@@ -0,0 +1,160 @@
+// Broadcast fan-out.
+//
+// Sending one announcement to N chats through gowhatsapp_go_send_message
+// costs N queue traversals and N serialized round-trips.
+// gowhatsapp_go_send_broadcast builds the waE2E.Message once, fans the
+// sends out across a small bounded pool of goroutines, and reports all
+// per-recipient outcomes through a single bridge_broadcast_results
+// crossing when the last send completes.
+package main
+
+/*
+#include <stdlib.h>
+#include "bridge.h"
+*/
+import "C"
+
+import (
+	"sync"
+	"time"
+	"unsafe"
+
+	"go.mau.fi/whatsmeow/proto/waE2E"
+	"google.golang.org/protobuf/proto"
+)
+
+// broadcastWorkers bounds concurrent sends per broadcast — enough to
+// overlap server round-trips without stampeding the connection.
+const broadcastWorkers = 4
+
+type broadcastResult struct {
+	jid      string
+	serverID string
+	status   int32 // 0 = accepted, nonzero = failed
+}
+
+//export gowhatsapp_go_send_broadcast
+func gowhatsapp_go_send_broadcast(account C.gowhatsapp_account_t, jidsC **C.char, count C.int, textC *C.char) C.uint64_t {
+	stats.cgoCallsIn.Add(1)
+	key := uintptr(account)
+
+	state := registry.lookup(key)
+	if state == nil || !state.ready.Load() || count <= 0 {
+		return 0
+	}
+
+	jids := make([]string, 0, int(count))
+	for _, p := range unsafe.Slice(jidsC, int(count)) {
+		if jid := C.GoString(p); jid != "" {
+			jids = append(jids, jid)
+		}
+	}
+	if len(jids) == 0 {
+		return 0
+	}
+
+	token := nextSendToken()
+	go runBroadcast(account, state, token, jids, C.GoString(textC))
+	return C.uint64_t(token)
+}
+
+// runBroadcast fans the shared message out and delivers the collected
+// results in one crossing once every send has finished.
+func runBroadcast(account C.gowhatsapp_account_t, state *accountState, token uint64, jids []string, text string) {
+	// Built once; SendMessage only reads it, so sharing across the
+	// pool is safe.
+	msg := &waE2E.Message{
+		Conversation: proto.String(text),
+	}
+
+	results := make([]broadcastResult, len(jids))
+	sem := make(chan struct{}, broadcastWorkers)
+	var wg sync.WaitGroup
+
+	for i, jid := range jids {
+		wg.Add(1)
+		sem <- struct{}{}
+		go func(i int, jid string) {
+			defer wg.Done()
+			defer func() { <-sem }()
+			results[i] = broadcastOne(state, jid, text, msg)
+		}(i, jid)
+	}
+	wg.Wait()
+
+	deliverBroadcastResults(account, token, results)
+}
+
+// broadcastOne sends the shared message to one recipient, with the same
+// receipt correlation and archiving as the ordered send path.
+func broadcastOne(state *accountState, jid, text string, msg *waE2E.Message) broadcastResult {
+	targetJID, err := parseJIDCached(jid)
+	if err != nil {
+		stats.sendsFailed.Add(1)
+		return broadcastResult{jid: jid, status: -1}
+	}
+
+	start := time.Now()
+	resp, err := state.client.SendMessage(state.ctx, targetJID, msg)
+	if err != nil {
+		stats.sendsFailed.Add(1)
+		return broadcastResult{jid: jid, status: -1}
+	}
+	stats.sendRTT.observe(time.Since(start))
+	stats.sendsOK.Add(1)
+
+	state.sent.record(resp.ID)
+
+	sender := "me"
+	if state.client.Store.ID != nil {
+		sender = state.client.Store.ID.String()
+	}
+	state.archive.append(jid, incomingMessage{
+		senderJID: sender,
+		chatJID:   jid,
+		text:      text,
+		messageID: resp.ID,
+		timestamp: resp.Timestamp.Unix(),
+		fromMe:    true,
+	})
+
+	return broadcastResult{jid: jid, serverID: resp.ID, status: 0}
+}
+
+// deliverBroadcastResults arena-packs the batch and makes the single
+// results crossing.
+func deliverBroadcastResults(account C.gowhatsapp_account_t, token uint64, results []broadcastResult) {
+	count := len(results)
+	structBytes := count * C.sizeof_bridge_broadcast_result_t
+	arenaBytes := 0
+	for _, r := range results {
+		arenaBytes += len(r.jid) + len(r.serverID) + 2
+	}
+
+	base := C.malloc(C.size_t(structBytes + arenaBytes))
+	entries := unsafe.Slice((*C.bridge_broadcast_result_t)(base), count)
+	arenaPtr := unsafe.Add(base, structBytes)
+	arena := unsafe.Slice((*byte)(arenaPtr), arenaBytes)
+
+	pos := 0
+	put := func(s string) C.uint32_t {
+		off := pos
+		copy(arena[pos:], s)
+		pos += len(s)
+		arena[pos] = 0
+		pos++
+		return C.uint32_t(off)
+	}
+
+	for i, r := range results {
+		entries[i].jid_off = put(r.jid)
+		entries[i].message_id_off = put(r.serverID)
+		entries[i].status = C.int32_t(r.status)
+	}
+
+	C.bridge_broadcast_results(account, C.uint64_t(token),
+		(*C.bridge_broadcast_result_t)(base), C.int(count),
+		(*C.char)(arenaPtr), C.int(arenaBytes))
+
+	C.free(base)
+}
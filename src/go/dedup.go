@@ -0,0 +1,66 @@
+// Duplicate message suppression.
+//
+// After reconnects and history overlaps whatsmeow can re-deliver a
+// message it already handed us, and each duplicate used to pay the full
+// CGO + libpurple delivery cost and land in the conversation twice. A
+// per-chat LRU of recently seen message IDs now drops duplicates on the
+// Go side before they are archived or cross the bridge. Memory is
+// bounded: a fixed-size ring per chat, oldest IDs evicted first.
+package main
+
+import "sync"
+
+// dedupPerChat is how many recent message IDs are remembered per chat.
+// Re-deliveries cluster tightly around reconnects, so a few hundred IDs
+// per chat catches them without unbounded growth.
+const dedupPerChat = 256
+
+// chatSeen is one chat's bounded ID ring with O(1) membership.
+type chatSeen struct {
+	ids   map[string]struct{}
+	order []string
+	next  int
+}
+
+// dedupIndex tracks recently seen message IDs across chats. Callers are
+// the dispatch workers and history ingestion.
+type dedupIndex struct {
+	mu    sync.Mutex
+	chats map[string]*chatSeen
+}
+
+func newDedupIndex() *dedupIndex {
+	return &dedupIndex{chats: make(map[string]*chatSeen)}
+}
+
+// seen records the ID and reports whether it had already been recorded —
+// TRUE means the message is a duplicate and must be dropped.
+func (d *dedupIndex) seen(chat, id string) bool {
+	if id == "" {
+		return false
+	}
+
+	d.mu.Lock()
+	defer d.mu.Unlock()
+
+	c := d.chats[chat]
+	if c == nil {
+		c = &chatSeen{
+			ids:   make(map[string]struct{}, dedupPerChat),
+			order: make([]string, dedupPerChat),
+		}
+		d.chats[chat] = c
+	}
+
+	if _, dup := c.ids[id]; dup {
+		return true
+	}
+
+	if old := c.order[c.next]; old != "" {
+		delete(c.ids, old)
+	}
+	c.order[c.next] = id
+	c.next = (c.next + 1) % dedupPerChat
+	c.ids[id] = struct{}{}
+	return false
+}
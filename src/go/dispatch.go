@@ -0,0 +1,98 @@
+// Event dispatch engine.
+//
+// whatsmeow invokes our event handler inline on its event goroutine, so
+// one expensive event (large message, media metadata) used to delay
+// every subsequent event for all chats. Events are now fanned out to a
+// small worker pool keyed by chat JID: the same chat always hashes to
+// the same worker (preserving per-chat ordering) while a busy group can
+// no longer add latency to other conversations. Queues are bounded; a
+// full queue applies backpressure to whatsmeow rather than buffering
+// without limit.
+package main
+
+/*
+#include "bridge.h"
+*/
+import "C"
+
+import (
+	"hash/fnv"
+
+	"go.mau.fi/whatsmeow/types/events"
+)
+
+const (
+	// dispatchWorkers is the fan-out width. Per-chat ordering comes from
+	// consistent hashing, so this only bounds cross-chat parallelism.
+	dispatchWorkers = 4
+	// dispatchQueueDepth bounds each worker's backlog before submission
+	// blocks (backpressure on whatsmeow's event goroutine).
+	dispatchQueueDepth = 128
+)
+
+// eventDispatcher fans events out across ordered per-chat queues.
+type eventDispatcher struct {
+	queues []chan interface{}
+}
+
+func newEventDispatcher() *eventDispatcher {
+	d := &eventDispatcher{
+		queues: make([]chan interface{}, dispatchWorkers),
+	}
+	for i := range d.queues {
+		d.queues[i] = make(chan interface{}, dispatchQueueDepth)
+	}
+	return d
+}
+
+// start launches one goroutine per queue, each running handleEvent in
+// arrival order for the chats hashed to it.
+func (d *eventDispatcher) start(account C.gowhatsapp_account_t, state *accountState) {
+	for _, q := range d.queues {
+		go func(q chan interface{}) {
+			for {
+				select {
+				case evt := <-q:
+					handleEvent(account, state, evt)
+				case <-state.ctx.Done():
+					return
+				}
+			}
+		}(q)
+	}
+}
+
+// submit routes an event to its chat's worker, blocking when the queue
+// is full.
+func (d *eventDispatcher) submit(state *accountState, evt interface{}) {
+	h := fnv.New32a()
+	h.Write([]byte(dispatchKey(evt)))
+	q := d.queues[h.Sum32()%uint32(len(d.queues))]
+
+	select {
+	case q <- evt:
+	case <-state.ctx.Done():
+	}
+}
+
+// dispatchKey returns the ordering domain for an event: the chat JID for
+// messages, the sender for presence-like events, and "" for everything
+// global (connection state, history sync), which all share one worker.
+func dispatchKey(evt interface{}) string {
+	switch v := evt.(type) {
+	case *events.Message:
+		return v.Info.Chat.String()
+	case *events.Receipt:
+		return v.Chat.String()
+	case *events.Presence:
+		return v.From.String()
+	case *events.ChatPresence:
+		return v.MessageSource.Chat.String()
+	case *events.GroupInfo:
+		return v.JID.String()
+	case *events.Picture:
+		return v.JID.String()
+	default:
+		return ""
+	}
+}
@@ -0,0 +1,232 @@
+// Group metadata cache.
+//
+// Group messages arrive with bare JIDs, and resolving a subject or a
+// participant list used to mean a GetGroupInfo network round-trip per
+// lookup — and freshly joined purple chats had no member list at all.
+// Metadata now lives in a per-account cache persisted beside the
+// session DB: loaded and pushed to C at login (so reopening Pidgin has
+// subjects and member lists before the socket is even up), warmed with
+// one batched GetJoinedGroups call after connect, and patched
+// incrementally from events.GroupInfo. The delivery hot path never
+// touches the network.
+package main
+
+/*
+#include "bridge.h"
+#include <stdlib.h>
+*/
+import "C"
+
+import (
+	"encoding/json"
+	"os"
+	"sync"
+	"unsafe"
+
+	"go.mau.fi/whatsmeow/types/events"
+)
+
+// groupParticipant is one cached group member.
+type groupParticipant struct {
+	JID   string `json:"jid"`
+	Admin bool   `json:"admin"`
+}
+
+// groupMeta is the cached state of one group.
+type groupMeta struct {
+	Subject      string             `json:"subject"`
+	Participants []groupParticipant `json:"participants"`
+}
+
+// groupCache holds and persists one account's group metadata.
+type groupCache struct {
+	mu     sync.Mutex
+	path   string
+	groups map[string]groupMeta
+}
+
+// newGroupCache loads the persisted cache, or starts empty.
+func newGroupCache(path string) *groupCache {
+	g := &groupCache{
+		path:   path,
+		groups: make(map[string]groupMeta),
+	}
+	if data, err := os.ReadFile(path); err == nil {
+		json.Unmarshal(data, &g.groups)
+	}
+	return g
+}
+
+// save persists the cache. Best effort, called with g.mu held.
+func (g *groupCache) save() {
+	data, err := json.Marshal(g.groups)
+	if err != nil {
+		return
+	}
+	os.WriteFile(g.path, data, 0600)
+}
+
+// put replaces one group's metadata and persists.
+func (g *groupCache) put(jid string, meta groupMeta) {
+	g.mu.Lock()
+	g.groups[jid] = meta
+	g.save()
+	g.mu.Unlock()
+}
+
+// get returns one group's metadata, if cached.
+func (g *groupCache) get(jid string) (groupMeta, bool) {
+	g.mu.Lock()
+	meta, ok := g.groups[jid]
+	g.mu.Unlock()
+	return meta, ok
+}
+
+// snapshot returns a copy of the whole cache for iteration.
+func (g *groupCache) snapshot() map[string]groupMeta {
+	g.mu.Lock()
+	defer g.mu.Unlock()
+	out := make(map[string]groupMeta, len(g.groups))
+	for k, v := range g.groups {
+		out[k] = v
+	}
+	return out
+}
+
+// pushGroupCache delivers every cached group to the C side — called at
+// login so chat user lists populate before the connection is up.
+func pushGroupCache(account C.gowhatsapp_account_t, state *accountState) {
+	for jid, meta := range state.groups.snapshot() {
+		deliverGroupMeta(account, jid, meta)
+	}
+}
+
+// warmGroupCache refreshes the cache with one batched fetch after
+// connect, pushing any group whose metadata changed.
+func warmGroupCache(account C.gowhatsapp_account_t, state *accountState) {
+	infos, err := state.client.GetJoinedGroups(state.ctx)
+	if err != nil {
+		return
+	}
+
+	for _, info := range infos {
+		meta := groupMeta{Subject: info.Name}
+		for _, p := range info.Participants {
+			meta.Participants = append(meta.Participants, groupParticipant{
+				JID:   p.JID.String(),
+				Admin: p.IsAdmin || p.IsSuperAdmin,
+			})
+		}
+
+		jid := info.JID.String()
+		if old, ok := state.groups.get(jid); ok && metaEqual(old, meta) {
+			continue
+		}
+		state.groups.put(jid, meta)
+		deliverGroupMeta(account, jid, meta)
+	}
+}
+
+func metaEqual(a, b groupMeta) bool {
+	if a.Subject != b.Subject || len(a.Participants) != len(b.Participants) {
+		return false
+	}
+	for i := range a.Participants {
+		if a.Participants[i] != b.Participants[i] {
+			return false
+		}
+	}
+	return true
+}
+
+// handleGroupInfo patches the cache from one incremental group-change
+// event and pushes the updated metadata.
+func handleGroupInfo(account C.gowhatsapp_account_t, state *accountState, v *events.GroupInfo) {
+	jid := v.JID.String()
+	meta, _ := state.groups.get(jid)
+
+	if v.Name != nil {
+		meta.Subject = v.Name.Name
+	}
+	for _, j := range v.Join {
+		meta.Participants = addParticipant(meta.Participants, j.String())
+	}
+	for _, j := range v.Leave {
+		meta.Participants = removeParticipant(meta.Participants, j.String())
+	}
+	for _, j := range v.Promote {
+		meta.Participants = setAdmin(meta.Participants, j.String(), true)
+	}
+	for _, j := range v.Demote {
+		meta.Participants = setAdmin(meta.Participants, j.String(), false)
+	}
+
+	state.groups.put(jid, meta)
+	deliverGroupMeta(account, jid, meta)
+}
+
+func addParticipant(parts []groupParticipant, jid string) []groupParticipant {
+	for _, p := range parts {
+		if p.JID == jid {
+			return parts
+		}
+	}
+	return append(parts, groupParticipant{JID: jid})
+}
+
+func removeParticipant(parts []groupParticipant, jid string) []groupParticipant {
+	for i, p := range parts {
+		if p.JID == jid {
+			return append(parts[:i], parts[i+1:]...)
+		}
+	}
+	return parts
+}
+
+func setAdmin(parts []groupParticipant, jid string, admin bool) []groupParticipant {
+	for i, p := range parts {
+		if p.JID == jid {
+			parts[i].Admin = admin
+			return parts
+		}
+	}
+	return append(parts, groupParticipant{JID: jid, Admin: admin})
+}
+
+// deliverGroupMeta packs one group's metadata (participant structs +
+// JID arena) and crosses once.
+func deliverGroupMeta(account C.gowhatsapp_account_t, jid string, meta groupMeta) {
+	count := len(meta.Participants)
+	structBytes := count * C.sizeof_bridge_participant_t
+	arenaBytes := 0
+	for _, p := range meta.Participants {
+		arenaBytes += len(p.JID) + 1
+	}
+	if arenaBytes == 0 {
+		arenaBytes = 1 // keep the allocation non-empty for empty groups
+	}
+
+	base := C.malloc(C.size_t(structBytes + arenaBytes))
+	entries := unsafe.Slice((*C.bridge_participant_t)(base), count)
+	arenaPtr := unsafe.Add(base, structBytes)
+	arena := unsafe.Slice((*byte)(arenaPtr), arenaBytes)
+
+	pos := 0
+	for i, p := range meta.Participants {
+		entries[i].jid_off = C.uint32_t(pos)
+		copy(arena[pos:], p.JID)
+		pos += len(p.JID)
+		arena[pos] = 0
+		pos++
+		entries[i].is_admin = boolToC(p.Admin)
+	}
+
+	cJID := C.CString(jid)
+	cSubject := C.CString(meta.Subject)
+	C.bridge_group_metadata(account, cJID, cSubject,
+		(*C.bridge_participant_t)(base), C.int(count),
+		(*C.char)(arenaPtr), C.int(pos))
+	C.free(unsafe.Pointer(cJID))
+	C.free(unsafe.Pointer(cSubject))
+	C.free(base)
+}
@@ -0,0 +1,102 @@
+// History sync ingestion.
+//
+// After a fresh pairing WhatsApp pushes the account's message history in
+// events.HistorySync chunks. We stream each chunk conversation by
+// conversation with bounded memory: one conversation's chunk is parsed
+// and time-sorted at a time (chunks themselves are bounded), every
+// message is appended to the local message archive (archive.go), and
+// only a small per-chat tail is delivered to libpurple — through the
+// normal batch pipeline, so a 50k-message history never lands in one UI
+// update.
+package main
+
+/*
+#include "bridge.h"
+*/
+import "C"
+
+import (
+	"sort"
+
+	"go.mau.fi/whatsmeow/types"
+	"go.mau.fi/whatsmeow/types/events"
+)
+
+const (
+	// historyBackfillPerChat is how many of the most recent messages per
+	// chat are replayed into the conversation window.
+	historyBackfillPerChat = 50
+)
+
+// ingestHistorySync processes one history sync chunk. It walks the
+// conversations in the chunk sequentially, archiving every message and
+// keeping only a bounded tail per chat for delivery.
+func ingestHistorySync(account C.gowhatsapp_account_t, state *accountState, evt *events.HistorySync) {
+	data := evt.Data
+	if data == nil {
+		return
+	}
+
+	for _, conv := range data.GetConversations() {
+		chatJIDStr := conv.GetID()
+		chatJID, err := types.ParseJID(chatJIDStr)
+		if err != nil {
+			continue
+		}
+
+		parsed := make([]incomingMessage, 0, len(conv.GetMessages()))
+
+		for _, histMsg := range conv.GetMessages() {
+			webMsg := histMsg.GetMessage()
+			if webMsg == nil {
+				continue
+			}
+			webParsed, err := state.client.ParseWebMessage(chatJID, webMsg)
+			if err != nil {
+				continue
+			}
+			msg, ok := extractMessage(webParsed)
+			if !ok {
+				continue
+			}
+			parsed = append(parsed, msg)
+		}
+
+		// The payload's ordering is not guaranteed — sync chunks
+		// commonly arrive newest first. Sort ascending so the archive
+		// is appended chronologically and the tail really is the
+		// newest messages, replayed oldest first.
+		sort.Slice(parsed, func(i, j int) bool {
+			return parsed[i].timestamp < parsed[j].timestamp
+		})
+
+		// Bounded tail of the newest displayable messages, oldest first.
+		tail := make([]incomingMessage, 0, historyBackfillPerChat)
+
+		for _, msg := range parsed {
+			// Skip messages already seen live (or in an overlapping
+			// chunk) — they are archived and delivered once.
+			if state.dedup.seen(chatJIDStr, msg.messageID) {
+				continue
+			}
+
+			state.archive.append(chatJIDStr, msg)
+
+			if len(tail) == historyBackfillPerChat {
+				copy(tail, tail[1:])
+				tail = tail[:historyBackfillPerChat-1]
+			}
+			tail = append(tail, msg)
+		}
+
+		// Replay through the batcher so delivery shares the same bounded
+		// batches (and the same CGO amortization) as live traffic.
+		for _, msg := range tail {
+			select {
+			case state.msgCh <- msg:
+			case <-state.ctx.Done():
+				return
+			}
+		}
+	}
+}
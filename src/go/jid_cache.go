@@ -0,0 +1,61 @@
+// Interned JID parsing for the send paths.
+//
+// Every send-side entry point used to call types.ParseJID on each
+// invocation, though traffic concentrates on a few dozen active chats —
+// typing notifications alone re-parse the same JID several times a
+// second. parseJIDCached fronts the parser with a bounded read-mostly
+// map keyed by the raw string, so steady-state sends cost one read-lock
+// hash lookup instead of a parse plus allocation. Parsed types.JID
+// values are immutable, so sharing them across goroutines is safe.
+package main
+
+import (
+	"sync"
+
+	"go.mau.fi/whatsmeow/types"
+)
+
+// jidCacheCap bounds the cache; eviction is oldest-first via the same
+// fixed FIFO ring used by sentIndex and dedupIndex. Only successfully
+// parsed JIDs are cached, so malformed input cannot churn the ring.
+const jidCacheCap = 256
+
+type jidCache struct {
+	mu    sync.RWMutex
+	jids  map[string]types.JID
+	order [jidCacheCap]string
+	next  int
+}
+
+var parsedJIDs = jidCache{jids: make(map[string]types.JID, jidCacheCap)}
+
+// parseJIDCached returns the parsed form of `s`, consulting the cache
+// first. Shared by all send-side entry points.
+func parseJIDCached(s string) (types.JID, error) {
+	parsedJIDs.mu.RLock()
+	jid, ok := parsedJIDs.jids[s]
+	parsedJIDs.mu.RUnlock()
+	if ok {
+		return jid, nil
+	}
+
+	jid, err := types.ParseJID(s)
+	if err != nil {
+		return jid, err
+	}
+
+	parsedJIDs.mu.Lock()
+	// Re-check under the write lock — another goroutine may have
+	// inserted while we parsed; don't burn a ring slot on a duplicate.
+	if _, ok := parsedJIDs.jids[s]; !ok {
+		if evict := parsedJIDs.order[parsedJIDs.next]; evict != "" {
+			delete(parsedJIDs.jids, evict)
+		}
+		parsedJIDs.order[parsedJIDs.next] = s
+		parsedJIDs.next = (parsedJIDs.next + 1) % jidCacheCap
+		parsedJIDs.jids[s] = jid
+	}
+	parsedJIDs.mu.Unlock()
+
+	return jid, nil
+}
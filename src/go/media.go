@@ -0,0 +1,210 @@
+// Media download engine.
+//
+// Implements the auto-download-images account option: image, video, and
+// document payloads are fetched through whatsmeow's download API on a
+// bounded worker pool and stored in a content-addressed disk cache under
+// ~/.purple/whatsmeow/media/ keyed by the payload's SHA-256 — a re-sent
+// or re-received file costs zero network. Images are delivered to C with
+// their bytes inline (for the purple image store); other types are
+// delivered by cache path.
+package main
+
+/*
+#include "bridge.h"
+#include <stdlib.h>
+*/
+import "C"
+
+import (
+	"encoding/hex"
+	"os"
+	"path/filepath"
+	"sync/atomic"
+	"unsafe"
+
+	"go.mau.fi/whatsmeow"
+	"go.mau.fi/whatsmeow/types/events"
+)
+
+// mediaConcurrency caps simultaneous downloads per account so a burst of
+// media-heavy messages cannot saturate the connection.
+const mediaConcurrency = 3
+
+// mediaDownloader is the per-account download pool and cache handle.
+type mediaDownloader struct {
+	dir     string        // content-addressed cache directory
+	sem     chan struct{} // bounds concurrent downloads
+	enabled atomic.Bool
+}
+
+func newMediaDownloader(dir string) *mediaDownloader {
+	os.MkdirAll(dir, 0700)
+	return &mediaDownloader{
+		dir: dir,
+		sem: make(chan struct{}, mediaConcurrency),
+	}
+}
+
+//export gowhatsapp_go_set_media_auto_download
+func gowhatsapp_go_set_media_auto_download(account C.gowhatsapp_account_t, enabled C.int) {
+	state := registry.lookup(uintptr(account))
+	if state == nil {
+		return
+	}
+	state.media.enabled.Store(enabled != 0)
+}
+
+// mediaPayload describes one downloadable attachment.
+type mediaPayload struct {
+	downloadable whatsmeow.DownloadableMessage
+	sha256       []byte
+	mimetype     string
+	caption      string
+	inline       bool // deliver bytes to C (images)
+}
+
+// extractMediaPayload returns the downloadable attachment of a message,
+// if it carries one we handle.
+func extractMediaPayload(v *events.Message) (mediaPayload, bool) {
+	if img := v.Message.GetImageMessage(); img != nil {
+		return mediaPayload{img, img.GetFileSHA256(), img.GetMimetype(), img.GetCaption(), true}, true
+	}
+	if vid := v.Message.GetVideoMessage(); vid != nil {
+		return mediaPayload{vid, vid.GetFileSHA256(), vid.GetMimetype(), vid.GetCaption(), false}, true
+	}
+	if doc := v.Message.GetDocumentMessage(); doc != nil {
+		return mediaPayload{doc, doc.GetFileSHA256(), doc.GetMimetype(), doc.GetTitle(), false}, true
+	}
+	return mediaPayload{}, false
+}
+
+// shouldHandle reports whether this message should go through the media
+// pipeline instead of plain text delivery.
+func (m *mediaDownloader) shouldHandle(v *events.Message) bool {
+	if !m.enabled.Load() {
+		return false
+	}
+	payload, ok := extractMediaPayload(v)
+	return ok && len(payload.sha256) > 0
+}
+
+// cachePath derives the content-addressed location for a payload.
+func (m *mediaDownloader) cachePath(payload mediaPayload) string {
+	name := hex.EncodeToString(payload.sha256) + mediaExtension(payload.mimetype)
+	return filepath.Join(m.dir, name)
+}
+
+// fetch resolves a media message through the cache (or network, bounded
+// by the pool) and delivers it across the bridge. Runs on its own
+// goroutine; failures fall back to plain text delivery.
+func (m *mediaDownloader) fetch(account C.gowhatsapp_account_t, state *accountState, v *events.Message) {
+	payload, _ := extractMediaPayload(v)
+	path := m.cachePath(payload)
+
+	// handleMessage archives before handing a message off; messages
+	// routed here must reach the archive too, or reopened conversations
+	// backfill without any of their media. Archive the same placeholder
+	// record extractMessage produces — it covers delivery and the
+	// plain-text fallback below alike.
+	if msg, ok := extractMessage(v); ok {
+		state.archive.append(msg.chatJID, msg)
+	}
+
+	data, err := os.ReadFile(path)
+	if err != nil {
+		// Cache miss — download under the concurrency cap.
+		select {
+		case m.sem <- struct{}{}:
+		case <-state.ctx.Done():
+			return
+		}
+		data, err = state.client.Download(state.ctx, payload.downloadable)
+		<-m.sem
+
+		if err != nil {
+			// Fall back to the text placeholder path.
+			if msg, ok := extractMessage(v); ok {
+				select {
+				case state.msgCh <- msg:
+				case <-state.ctx.Done():
+				}
+			}
+			return
+		}
+		os.WriteFile(path, data, 0600)
+	}
+
+	if !payload.inline {
+		data = nil // deliver by path only
+	}
+	deliverMedia(account, v, payload, path, data)
+}
+
+// deliverMedia packs one media message (strings + optional payload
+// bytes) into a single arena allocation and crosses once.
+func deliverMedia(account C.gowhatsapp_account_t, v *events.Message, payload mediaPayload, path string, data []byte) {
+	stats.mediaIn.Add(1)
+	chatJID := v.Info.Chat.String()
+	senderJID := v.Info.Sender.String()
+	pushName := v.Info.PushName
+	messageID := v.Info.ID
+
+	arenaBytes := len(chatJID) + len(senderJID) + len(pushName) +
+		len(messageID) + len(payload.caption) + len(path) +
+		len(payload.mimetype) + 7 + len(data)
+
+	base := C.malloc(C.size_t(C.sizeof_bridge_media_t + arenaBytes))
+	media := (*C.bridge_media_t)(base)
+	arenaPtr := unsafe.Add(base, C.sizeof_bridge_media_t)
+	arena := unsafe.Slice((*byte)(arenaPtr), arenaBytes)
+
+	pos := 0
+	put := func(s string) C.uint32_t {
+		off := pos
+		copy(arena[pos:], s)
+		pos += len(s)
+		arena[pos] = 0
+		pos++
+		return C.uint32_t(off)
+	}
+
+	media.chat_jid_off = put(chatJID)
+	media.sender_jid_off = put(senderJID)
+	media.push_name_off = put(pushName)
+	media.message_id_off = put(messageID)
+	media.caption_off = put(payload.caption)
+	media.path_off = put(path)
+	media.mimetype_off = put(payload.mimetype)
+	media.data_off = C.uint32_t(pos)
+	media.data_len = C.uint32_t(len(data))
+	copy(arena[pos:], data)
+	pos += len(data)
+
+	media.timestamp = C.int64_t(v.Info.Timestamp.Unix())
+	media.from_me = boolToC(v.Info.IsFromMe)
+	media.is_group = boolToC(v.Info.IsGroup)
+
+	C.bridge_receive_media(account, media, (*C.char)(arenaPtr), C.int(pos))
+
+	C.free(base)
+}
+
+// mediaExtension maps common WhatsApp mimetypes to file extensions.
+func mediaExtension(mimetype string) string {
+	switch mimetype {
+	case "image/jpeg":
+		return ".jpg"
+	case "image/png":
+		return ".png"
+	case "image/webp":
+		return ".webp"
+	case "image/gif":
+		return ".gif"
+	case "video/mp4":
+		return ".mp4"
+	case "application/pdf":
+		return ".pdf"
+	default:
+		return ".bin"
+	}
+}
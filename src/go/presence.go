@@ -0,0 +1,146 @@
+// Presence and typing coalescing.
+//
+// WhatsApp floods presence: reconnecting with a few hundred contacts
+// produces a storm of events.Presence/events.ChatPresence, and forwarding
+// each one across CGO triggers a status redraw per event. This stage
+// buffers updates per contact, keeps only the latest state, and flushes
+// batches to C on an interval (default 250 ms, configurable via
+// gowhatsapp_go_set_presence_flush), so N events for one contact cross
+// the bridge as one entry.
+package main
+
+/*
+#include "bridge.h"
+#include <stdlib.h>
+*/
+import "C"
+
+import (
+	"sync"
+	"time"
+	"unsafe"
+)
+
+const (
+	presenceKindAvailability = 0
+	presenceKindTyping       = 1
+
+	defaultPresenceFlush = 250 * time.Millisecond
+)
+
+// presenceKey identifies one contact+kind slot in the pending map.
+type presenceKey struct {
+	jid  string
+	kind int32
+}
+
+// presenceCoalescer accumulates latest-state presence updates between
+// flushes. Writers are event goroutines; the per-account flusher swaps
+// the map out under the same lock.
+type presenceCoalescer struct {
+	mu       sync.Mutex
+	pending  map[presenceKey]int32
+	interval time.Duration
+}
+
+func newPresenceCoalescer() *presenceCoalescer {
+	return &presenceCoalescer{
+		pending:  make(map[presenceKey]int32),
+		interval: defaultPresenceFlush,
+	}
+}
+
+// record stores the newest state for one contact, overwriting any update
+// not yet flushed.
+func (p *presenceCoalescer) record(jid string, kind, state int32) {
+	p.mu.Lock()
+	p.pending[presenceKey{jid: jid, kind: kind}] = state
+	p.mu.Unlock()
+}
+
+// take swaps out and returns the pending updates (nil when idle).
+func (p *presenceCoalescer) take() map[presenceKey]int32 {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	if len(p.pending) == 0 {
+		return nil
+	}
+	out := p.pending
+	p.pending = make(map[presenceKey]int32)
+	return out
+}
+
+//export gowhatsapp_go_set_presence_flush
+func gowhatsapp_go_set_presence_flush(account C.gowhatsapp_account_t, intervalMS C.int) {
+	key := uintptr(account)
+
+	state := registry.lookup(key)
+	if state == nil {
+		return
+	}
+
+	interval := defaultPresenceFlush
+	if intervalMS > 0 {
+		interval = time.Duration(intervalMS) * time.Millisecond
+	}
+
+	state.presence.mu.Lock()
+	state.presence.interval = interval
+	state.presence.mu.Unlock()
+}
+
+// runPresenceFlusher periodically drains the coalescer and delivers one
+// batched crossing per interval with pending updates.
+func runPresenceFlusher(account C.gowhatsapp_account_t, state *accountState) {
+	for {
+		state.presence.mu.Lock()
+		interval := state.presence.interval
+		state.presence.mu.Unlock()
+
+		select {
+		case <-time.After(interval):
+			if updates := state.presence.take(); updates != nil {
+				deliverPresenceBatch(account, updates)
+			}
+		case <-state.ctx.Done():
+			return
+		}
+	}
+}
+
+// deliverPresenceBatch packs the coalesced updates into one arena
+// allocation and crosses once, mirroring deliverMessageBatch.
+func deliverPresenceBatch(account C.gowhatsapp_account_t, updates map[presenceKey]int32) {
+	count := len(updates)
+	stats.presenceOut.Add(uint64(count))
+	structBytes := count * C.sizeof_bridge_presence_t
+	arenaBytes := 0
+	for k := range updates {
+		arenaBytes += len(k.jid) + 1
+	}
+
+	base := C.malloc(C.size_t(structBytes + arenaBytes))
+	entries := unsafe.Slice((*C.bridge_presence_t)(base), count)
+	arenaPtr := unsafe.Add(base, structBytes)
+	arena := unsafe.Slice((*byte)(arenaPtr), arenaBytes)
+
+	pos := 0
+	i := 0
+	for k, v := range updates {
+		off := pos
+		copy(arena[pos:], k.jid)
+		pos += len(k.jid)
+		arena[pos] = 0
+		pos++
+
+		entries[i].jid_off = C.uint32_t(off)
+		entries[i].kind = C.int32_t(k.kind)
+		entries[i].state = C.int32_t(v)
+		i++
+	}
+
+	C.bridge_presence_updates(account, (*C.bridge_presence_t)(base),
+		C.int(count), (*C.char)(arenaPtr), C.int(arenaBytes))
+
+	C.free(base)
+}
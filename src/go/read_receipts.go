@@ -0,0 +1,126 @@
+// Outgoing read receipt accumulation.
+//
+// client.MarkRead accepts a slice of message IDs, but the bridge used to
+// be called once per message — 200 CGO calls and 200 protocol sends to
+// acknowledge a 200-message backlog. Receipts now land in a per-chat
+// accumulator and a flusher merges everything that arrived within the
+// window (~500 ms) into a single MarkRead per chat.
+package main
+
+/*
+#include "bridge.h"
+*/
+import "C"
+
+import (
+	"sync"
+	"time"
+	"unsafe"
+
+	"go.mau.fi/whatsmeow/types"
+)
+
+// receiptFlushWindow is how long receipts accumulate before one merged
+// MarkRead goes out per chat.
+const receiptFlushWindow = 500 * time.Millisecond
+
+// receiptKey groups receipts that can be merged into one MarkRead call.
+type receiptKey struct {
+	chat   string
+	sender string
+}
+
+// receiptAccumulator buffers read receipts between flushes.
+type receiptAccumulator struct {
+	mu      sync.Mutex
+	pending map[receiptKey][]types.MessageID
+}
+
+func newReceiptAccumulator() *receiptAccumulator {
+	return &receiptAccumulator{
+		pending: make(map[receiptKey][]types.MessageID),
+	}
+}
+
+func (r *receiptAccumulator) add(chat, sender string, ids ...types.MessageID) {
+	key := receiptKey{chat: chat, sender: sender}
+	r.mu.Lock()
+	r.pending[key] = append(r.pending[key], ids...)
+	r.mu.Unlock()
+}
+
+// take swaps out and returns the pending receipts (nil when idle).
+func (r *receiptAccumulator) take() map[receiptKey][]types.MessageID {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	if len(r.pending) == 0 {
+		return nil
+	}
+	out := r.pending
+	r.pending = make(map[receiptKey][]types.MessageID)
+	return out
+}
+
+//export gowhatsapp_go_mark_read
+func gowhatsapp_go_mark_read(account C.gowhatsapp_account_t, jidC *C.char, msgIDC *C.char, senderC *C.char) {
+	stats.cgoCallsIn.Add(1)
+	key := uintptr(account)
+
+	state := registry.lookup(key)
+	msgID := C.GoString(msgIDC)
+	if state == nil || !state.ready.Load() || msgID == "" {
+		return
+	}
+
+	state.receipts.add(C.GoString(jidC), C.GoString(senderC), msgID)
+}
+
+//export gowhatsapp_go_mark_read_batch
+func gowhatsapp_go_mark_read_batch(account C.gowhatsapp_account_t, jidC *C.char, senderC *C.char, msgIDsC **C.char, count C.int) {
+	stats.cgoCallsIn.Add(1)
+	key := uintptr(account)
+
+	state := registry.lookup(key)
+	if state == nil || !state.ready.Load() || count <= 0 {
+		return
+	}
+
+	idPtrs := unsafe.Slice(msgIDsC, int(count))
+	ids := make([]types.MessageID, 0, int(count))
+	for _, p := range idPtrs {
+		if id := C.GoString(p); id != "" {
+			ids = append(ids, id)
+		}
+	}
+	if len(ids) == 0 {
+		return
+	}
+
+	state.receipts.add(C.GoString(jidC), C.GoString(senderC), ids...)
+}
+
+// runReceiptFlusher merges accumulated receipts into one MarkRead call
+// per chat every window.
+func runReceiptFlusher(account C.gowhatsapp_account_t, state *accountState) {
+	ticker := time.NewTicker(receiptFlushWindow)
+	defer ticker.Stop()
+
+	for {
+		select {
+		case <-ticker.C:
+			pending := state.receipts.take()
+			for key, ids := range pending {
+				chatJID, err := parseJIDCached(key.chat)
+				if err != nil {
+					continue
+				}
+				senderJID, _ := parseJIDCached(key.sender)
+				if state.client.MarkRead(ids, chatJID, senderJID, chatJID) == nil {
+					stats.receiptsOut.Add(uint64(len(ids)))
+				}
+			}
+		case <-state.ctx.Done():
+			return
+		}
+	}
+}
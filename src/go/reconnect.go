@@ -0,0 +1,77 @@
+// Reconnect manager.
+//
+// A network drop used to be fatal: bridge_disconnected raised a purple
+// connection error, Pidgin tore the account down, and the next login
+// repeated the whole cold path — store open, device load, handshake.
+// The accountState (container, device store, caches, queues) survives a
+// drop untouched, so the manager just redials the WebSocket on the warm
+// client with exponential backoff and jitter. libpurple is only
+// involved when every retry has failed; a resume after a blip is one
+// handshake, invisible to the UI.
+package main
+
+/*
+#include "bridge.h"
+*/
+import "C"
+
+import (
+	"fmt"
+	"math/rand"
+	"time"
+)
+
+const (
+	reconnectMaxAttempts = 8
+	reconnectBaseDelay   = 2 * time.Second
+	reconnectMaxDelay    = 2 * time.Minute
+)
+
+// startReconnect launches the manager for a dropped connection, at most
+// one per account at a time.
+func startReconnect(account C.gowhatsapp_account_t, state *accountState) {
+	if !state.retrying.CompareAndSwap(false, true) {
+		return
+	}
+	go runReconnect(account, state)
+}
+
+func runReconnect(account C.gowhatsapp_account_t, state *accountState) {
+	defer state.retrying.Store(false)
+
+	delay := reconnectBaseDelay
+	for attempt := 1; attempt <= reconnectMaxAttempts; attempt++ {
+		// Jittered sleep (0.5–1.5× the nominal delay) so a flock of
+		// clients dropped by the same outage doesn't redial in step.
+		sleep := delay/2 + time.Duration(rand.Int63n(int64(delay)))
+		select {
+		case <-time.After(sleep):
+		case <-state.ctx.Done():
+			// Intentional logout — no error to surface.
+			return
+		}
+
+		if state.client.IsConnected() {
+			return
+		}
+
+		reportConnecting(account, fmt.Sprintf(
+			"Reconnecting (attempt %d/%d)", attempt, reconnectMaxAttempts))
+
+		// The warm client still holds the device store and session
+		// keys; Connect is just the WebSocket dial and noise handshake.
+		// Success emits events.Connected, which flushes the send spool
+		// and refreshes the caches through the usual path.
+		if err := state.client.Connect(); err == nil {
+			return
+		}
+
+		if delay *= 2; delay > reconnectMaxDelay {
+			delay = reconnectMaxDelay
+		}
+	}
+
+	// Retries exhausted — now it is a real outage; let libpurple tear
+	// the connection down and show the error.
+	C.bridge_disconnected(account)
+}
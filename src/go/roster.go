@@ -0,0 +1,100 @@
+// Roster synchronization.
+//
+// The buddy list used to be built lazily as messages arrived, one buddy
+// per first contact — a fresh install showed an empty list and paid
+// buddy creation on the message hot path. After connect the whole
+// contact store is read in one pass and shipped to C as a single
+// bridge_sync_contacts snapshot; the C side diffs it against the
+// existing blist and applies only the additions, renames, and removals.
+package main
+
+/*
+#include <stdlib.h>
+#include "bridge.h"
+*/
+import "C"
+
+import (
+	"unsafe"
+
+	"go.mau.fi/whatsmeow/types"
+)
+
+type rosterEntry struct {
+	jid   string
+	alias string
+}
+
+// bestContactName picks the display name the blist should carry, in
+// the same preference order whatsmeow's own clients use.
+func bestContactName(info types.ContactInfo) string {
+	switch {
+	case info.FullName != "":
+		return info.FullName
+	case info.FirstName != "":
+		return info.FirstName
+	case info.PushName != "":
+		return info.PushName
+	case info.BusinessName != "":
+		return info.BusinessName
+	}
+	return ""
+}
+
+// syncRoster reads the contact store once and delivers the snapshot in
+// a single crossing. Runs on its own goroutine after connect.
+func syncRoster(account C.gowhatsapp_account_t, state *accountState) {
+	contacts, err := state.client.Store.Contacts.GetAllContacts(state.ctx)
+	if err != nil {
+		return
+	}
+
+	entries := make([]rosterEntry, 0, len(contacts))
+	for jid, info := range contacts {
+		if jid.Server != types.DefaultUserServer {
+			continue
+		}
+		entries = append(entries, rosterEntry{jid: jid.String(), alias: bestContactName(info)})
+	}
+	if len(entries) == 0 {
+		return
+	}
+
+	deliverRosterSnapshot(account, entries)
+}
+
+// deliverRosterSnapshot arena-packs the roster and makes the single
+// bridge_sync_contacts crossing.
+func deliverRosterSnapshot(account C.gowhatsapp_account_t, entries []rosterEntry) {
+	count := len(entries)
+	structBytes := count * C.sizeof_bridge_contact_t
+	arenaBytes := 0
+	for _, e := range entries {
+		arenaBytes += len(e.jid) + len(e.alias) + 2
+	}
+
+	base := C.malloc(C.size_t(structBytes + arenaBytes))
+	packed := unsafe.Slice((*C.bridge_contact_t)(base), count)
+	arenaPtr := unsafe.Add(base, structBytes)
+	arena := unsafe.Slice((*byte)(arenaPtr), arenaBytes)
+
+	pos := 0
+	put := func(s string) C.uint32_t {
+		off := pos
+		copy(arena[pos:], s)
+		pos += len(s)
+		arena[pos] = 0
+		pos++
+		return C.uint32_t(off)
+	}
+
+	for i, e := range entries {
+		packed[i].jid_off = put(e.jid)
+		packed[i].alias_off = put(e.alias)
+	}
+
+	C.bridge_sync_contacts(account, (*C.bridge_contact_t)(base),
+		C.int(count), (*C.char)(arenaPtr), C.int(arenaBytes))
+
+	C.free(base)
+}
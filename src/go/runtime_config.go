@@ -0,0 +1,32 @@
+// Embedded Go runtime tuning.
+//
+// The c-archive drags a full Go runtime into Pidgin's process: default
+// GOMAXPROCS starts a scheduler thread per core and the GC keeps heap
+// headroom sized for throughput workloads — measurable extra RSS on
+// big desktops for a bridge that mostly waits on a WebSocket. This
+// export lets the C side cap threads, tighten the GC, and set a soft
+// memory limit at plugin init, without rebuilding.
+package main
+
+/*
+#include "bridge.h"
+*/
+import "C"
+
+import (
+	"runtime"
+	"runtime/debug"
+)
+
+//export gowhatsapp_go_configure_runtime
+func gowhatsapp_go_configure_runtime(maxProcs, gcPercent, memLimitMB C.int) {
+	if maxProcs > 0 {
+		runtime.GOMAXPROCS(int(maxProcs))
+	}
+	if gcPercent > 0 {
+		debug.SetGCPercent(int(gcPercent))
+	}
+	if memLimitMB > 0 {
+		debug.SetMemoryLimit(int64(memLimitMB) << 20)
+	}
+}
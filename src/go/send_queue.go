@@ -0,0 +1,151 @@
+// Outgoing send pipeline.
+//
+// Sends are asynchronous: gowhatsapp_go_send_message enqueues onto a
+// per-account ordered queue and returns a correlation token immediately.
+// A dedicated goroutine per account services the queue in order and
+// reports completion through the bridge_send_result callback, so the
+// purple main loop never waits on a WhatsApp network round-trip.
+package main
+
+/*
+#include "bridge.h"
+#include <stdlib.h>
+*/
+import "C"
+
+import (
+	"errors"
+	"fmt"
+	"sync/atomic"
+	"time"
+	"unsafe"
+
+	"go.mau.fi/whatsmeow"
+	"go.mau.fi/whatsmeow/proto/waE2E"
+	"google.golang.org/protobuf/proto"
+)
+
+// outgoingSend is one queued text message awaiting transmission.
+type outgoingSend struct {
+	token uint64
+	jid   string
+	text  string
+}
+
+// sendQueueDepth bounds how many sends may be pending per account before
+// enqueueing fails (we fail fast rather than block the UI thread).
+const sendQueueDepth = 256
+
+// sendTokenCounter issues process-global correlation tokens, starting at 1
+// so that 0 can mean "enqueue failed".
+var sendTokenCounter uint64
+
+func nextSendToken() uint64 {
+	return atomic.AddUint64(&sendTokenCounter, 1)
+}
+
+//export gowhatsapp_go_send_message
+func gowhatsapp_go_send_message(account C.gowhatsapp_account_t, jidC *C.char, textC *C.char) C.uint64_t {
+	stats.cgoCallsIn.Add(1)
+	key := uintptr(account)
+
+	state := registry.lookup(key)
+	if state == nil || !state.ready.Load() {
+		return 0
+	}
+
+	s := outgoingSend{
+		token: nextSendToken(),
+		jid:   C.GoString(jidC),
+		text:  C.GoString(textC),
+	}
+
+	select {
+	case state.sendCh <- s:
+		stats.sendsQueued.Add(1)
+		return C.uint64_t(s.token)
+	default:
+		// Queue full — report failure immediately instead of blocking.
+		return 0
+	}
+}
+
+// runSendWorker services the per-account send queue in FIFO order.
+func runSendWorker(account C.gowhatsapp_account_t, state *accountState) {
+	for {
+		select {
+		case s := <-state.sendCh:
+			transmitSend(account, state, s)
+		case <-state.ctx.Done():
+			return
+		}
+	}
+}
+
+// transmitSend performs the actual network send for one queued message and
+// reports the outcome through bridge_send_result. While disconnected the
+// message goes to the offline spool instead of failing.
+func transmitSend(account C.gowhatsapp_account_t, state *accountState, s outgoingSend) {
+	targetJID, err := parseJIDCached(s.jid)
+	if err != nil {
+		reportError(account, fmt.Sprintf("Invalid JID %q: %v", s.jid, err))
+		reportSendResult(account, s.token, s.jid, -1, "", 0)
+		return
+	}
+
+	if !state.client.IsConnected() {
+		spoolSend(account, state, s)
+		return
+	}
+
+	msg := &waE2E.Message{
+		Conversation: proto.String(s.text),
+	}
+
+	start := time.Now()
+	resp, err := state.client.SendMessage(state.ctx, targetJID, msg)
+	if err != nil {
+		if errors.Is(err, whatsmeow.ErrNotConnected) {
+			// Dropped between the check and the send — spool it.
+			spoolSend(account, state, s)
+			return
+		}
+		stats.sendsFailed.Add(1)
+		reportError(account, fmt.Sprintf("Send failed: %v", err))
+		reportSendResult(account, s.token, s.jid, -1, "", 0)
+		return
+	}
+	stats.sendRTT.observe(time.Since(start))
+	stats.sendsOK.Add(1)
+
+	// Remember the server-assigned ID so delivered/read receipts can be
+	// correlated back to this send.
+	state.sent.record(resp.ID)
+
+	// Record the accepted send in the local archive so reopening the
+	// conversation backfills both sides of it.
+	sender := "me"
+	if state.client.Store.ID != nil {
+		sender = state.client.Store.ID.String()
+	}
+	state.archive.append(s.jid, incomingMessage{
+		senderJID: sender,
+		chatJID:   s.jid,
+		text:      s.text,
+		messageID: resp.ID,
+		timestamp: resp.Timestamp.Unix(),
+		fromMe:    true,
+	})
+
+	reportSendResult(account, s.token, s.jid, 0, resp.ID, resp.Timestamp.Unix())
+}
+
+// reportSendResult crosses to C with the outcome of one send.
+func reportSendResult(account C.gowhatsapp_account_t, token uint64, jid string, status int, serverID string, serverTS int64) {
+	cJID := C.CString(jid)
+	cServerID := C.CString(serverID)
+	C.bridge_send_result(account, C.uint64_t(token), cJID, C.int(status),
+		cServerID, C.int64_t(serverTS))
+	C.free(unsafe.Pointer(cJID))
+	C.free(unsafe.Pointer(cServerID))
+}
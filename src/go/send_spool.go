@@ -0,0 +1,133 @@
+// Persistent offline send spool.
+//
+// When the WebSocket is down, outgoing messages are appended to an
+// on-disk spool next to the session DB instead of being dropped. Once
+// the connection comes back (events.Connected), the spool is drained in
+// order through the normal send worker, so reconnect recovery is one
+// batch drain instead of the user retyping everything.
+//
+// Format: one JSON object per line, append-only. The file is truncated
+// after a successful drain. Like the session DB it is chmod 0600.
+package main
+
+/*
+#include "bridge.h"
+*/
+import "C"
+
+import (
+	"bufio"
+	"encoding/json"
+	"fmt"
+	"os"
+	"sync"
+)
+
+// spooledSend is one persisted outgoing message.
+type spooledSend struct {
+	Token uint64 `json:"token"`
+	JID   string `json:"jid"`
+	Text  string `json:"text"`
+}
+
+// sendSpool serializes access to one account's spool file.
+type sendSpool struct {
+	mu   sync.Mutex
+	path string
+}
+
+func newSendSpool(path string) *sendSpool {
+	return &sendSpool{path: path}
+}
+
+// append persists one message at the tail of the spool.
+func (s *sendSpool) append(e spooledSend) error {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	f, err := os.OpenFile(s.path, os.O_CREATE|os.O_WRONLY|os.O_APPEND, 0600)
+	if err != nil {
+		return err
+	}
+	defer f.Close()
+
+	line, err := json.Marshal(e)
+	if err != nil {
+		return err
+	}
+	line = append(line, '\n')
+	if _, err := f.Write(line); err != nil {
+		return err
+	}
+	return f.Sync()
+}
+
+// drain returns all spooled messages in order and truncates the spool.
+// Unparseable lines (torn writes from a crash) are skipped.
+func (s *sendSpool) drain() []spooledSend {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	f, err := os.Open(s.path)
+	if err != nil {
+		return nil
+	}
+
+	var entries []spooledSend
+	scanner := bufio.NewScanner(f)
+	scanner.Buffer(make([]byte, 0, 64*1024), 1024*1024)
+	for scanner.Scan() {
+		var e spooledSend
+		if json.Unmarshal(scanner.Bytes(), &e) == nil {
+			entries = append(entries, e)
+		}
+	}
+	f.Close()
+
+	os.Truncate(s.path, 0)
+	return entries
+}
+
+// spoolSend persists a message that could not be transmitted right now.
+// The send result is reported when the spool is flushed, not here.
+func spoolSend(account C.gowhatsapp_account_t, state *accountState, s outgoingSend) {
+	err := state.spool.append(spooledSend{Token: s.token, JID: s.jid, Text: s.text})
+	if err != nil {
+		reportError(account, fmt.Sprintf("Offline spool write failed: %v", err))
+		reportSendResult(account, s.token, s.jid, -1, "", 0)
+	}
+}
+
+// flushSendSpool re-enqueues all spooled messages onto the ordered send
+// queue. Called from the Connected event handler; also picks up spool
+// left over from a previous run.
+func flushSendSpool(account C.gowhatsapp_account_t, state *accountState) {
+	entries := state.spool.drain()
+	if len(entries) == 0 {
+		return
+	}
+
+	for i, e := range entries {
+		// A cancelled context means the send worker has exited; a
+		// select could still buffer into its channel (the case choice
+		// is random when both are ready) and the message would vanish
+		// with the truncated spool. Check first, and on cancellation
+		// put the whole remainder back on disk.
+		if state.ctx.Err() != nil {
+			for _, r := range entries[i:] {
+				spoolSend(account, state,
+					outgoingSend{token: r.Token, jid: r.JID, text: r.Text})
+			}
+			return
+		}
+		select {
+		case state.sendCh <- outgoingSend{token: e.Token, jid: e.JID, text: e.Text}:
+		case <-state.ctx.Done():
+			for _, r := range entries[i:] {
+				spoolSend(account, state,
+					outgoingSend{token: r.Token, jid: r.JID, text: r.Text})
+			}
+			return
+		}
+	}
+}
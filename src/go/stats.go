@@ -0,0 +1,100 @@
+// Bridge instrumentation: atomic counters and latency histograms.
+//
+// Every hot path increments a process-wide atomic — a single
+// uncontended add, cheap enough to leave on in production — and
+// gowhatsapp_go_get_stats renders the whole set on demand. Nothing is
+// sampled or aggregated in the background; idle cost is zero.
+package main
+
+/*
+#include <stdlib.h>
+#include "bridge.h"
+*/
+import "C"
+
+import (
+	"fmt"
+	"math/bits"
+	"strings"
+	"sync/atomic"
+	"time"
+)
+
+// latencyHist is a log2-bucketed duration histogram: bucket i counts
+// observations in [2^i, 2^(i+1)) milliseconds, with bucket 0 covering
+// everything under 1 ms and the last bucket open-ended.
+type latencyHist struct {
+	buckets [12]atomic.Uint64
+}
+
+func (h *latencyHist) observe(d time.Duration) {
+	ms := uint64(d.Milliseconds())
+	idx := bits.Len64(ms) // 0ms → 0, 1ms → 1, 2-3ms → 2, ...
+	if idx >= len(h.buckets) {
+		idx = len(h.buckets) - 1
+	}
+	h.buckets[idx].Add(1)
+}
+
+func (h *latencyHist) render() string {
+	var b strings.Builder
+	for i := range h.buckets {
+		n := h.buckets[i].Load()
+		if n == 0 {
+			continue
+		}
+		if b.Len() > 0 {
+			b.WriteString("  ")
+		}
+		switch {
+		case i == 0:
+			fmt.Fprintf(&b, "<1ms:%d", n)
+		case i == len(h.buckets)-1:
+			fmt.Fprintf(&b, ">=%dms:%d", uint64(1)<<(i-1), n)
+		default:
+			fmt.Fprintf(&b, "%d-%dms:%d", uint64(1)<<(i-1), uint64(1)<<i-1, n)
+		}
+	}
+	if b.Len() == 0 {
+		return "(no samples)"
+	}
+	return b.String()
+}
+
+// bridgeStats is the process-wide counter set. All fields are atomics;
+// hot paths only ever Add.
+type bridgeStats struct {
+	cgoCallsIn     atomic.Uint64 // C→Go export invocations
+	messagesIn     atomic.Uint64 // messages delivered to C
+	messageBatches atomic.Uint64 // delivery crossings (batches)
+	mediaIn        atomic.Uint64 // media messages delivered
+	sendsQueued    atomic.Uint64
+	sendsOK        atomic.Uint64
+	sendsFailed    atomic.Uint64
+	presenceOut    atomic.Uint64 // coalesced presence updates delivered
+	receiptsOut    atomic.Uint64 // read receipts sent to the server
+	storeOpenUS    atomic.Int64  // last session store open, microseconds
+	sendRTT        latencyHist   // SendMessage round-trip
+}
+
+var stats bridgeStats
+
+func (s *bridgeStats) render() string {
+	var b strings.Builder
+	fmt.Fprintf(&b, "cgo calls in: %d\n", s.cgoCallsIn.Load())
+	fmt.Fprintf(&b, "messages in: %d in %d batches, media: %d\n",
+		s.messagesIn.Load(), s.messageBatches.Load(), s.mediaIn.Load())
+	fmt.Fprintf(&b, "sends: %d queued, %d ok, %d failed\n",
+		s.sendsQueued.Load(), s.sendsOK.Load(), s.sendsFailed.Load())
+	fmt.Fprintf(&b, "send round-trip: %s\n", s.sendRTT.render())
+	fmt.Fprintf(&b, "presence updates out: %d, receipts out: %d\n",
+		s.presenceOut.Load(), s.receiptsOut.Load())
+	fmt.Fprintf(&b, "session store open: %.1f ms\n",
+		float64(s.storeOpenUS.Load())/1000)
+	return b.String()
+}
+
+//export gowhatsapp_go_get_stats
+func gowhatsapp_go_get_stats() *C.char {
+	return C.CString(stats.render())
+}
@@ -27,17 +27,16 @@ import (
 	"fmt"
 	"os"
 	"path/filepath"
-	"sync"
+	"sync/atomic"
+	"time"
 	"unsafe"
 
 	_ "github.com/mattn/go-sqlite3"
 	"go.mau.fi/whatsmeow"
-	"go.mau.fi/whatsmeow/proto/waE2E"
 	"go.mau.fi/whatsmeow/store/sqlstore"
 	"go.mau.fi/whatsmeow/types"
 	"go.mau.fi/whatsmeow/types/events"
 	waLog "go.mau.fi/whatsmeow/util/log"
-	"google.golang.org/protobuf/proto"
 )
 
 // accountState holds per-account whatsmeow state.
@@ -46,11 +45,45 @@ type accountState struct {
 	container *sqlstore.Container
 	ctx       context.Context
 	cancel    context.CancelFunc
+	msgCh     chan incomingMessage // feeds the per-account delivery batcher
+	sendCh    chan outgoingSend    // feeds the per-account ordered send worker
+	spool     *sendSpool           // persistent store for sends while offline
+	archive   *messageArchive      // mmap-readable per-chat message archive
+	presence  *presenceCoalescer   // latest-state presence/typing buffer
+	receipts  *receiptAccumulator  // read receipts awaiting a merged send
+	sent      *sentIndex           // recently sent IDs for receipt correlation
+	acks      *ackBatcher          // incoming receipt transitions per window
+	dispatch  *eventDispatcher     // per-chat ordered event fan-out
+	dedup     *dedupIndex          // recently seen IDs, drops re-deliveries
+	groups    *groupCache          // persistent group metadata + participants
+	avatars   *avatarEngine        // paced buddy icon fetches + disk cache
+	media     *mediaDownloader     // bounded download pool + disk cache
+	ready     atomic.Bool          // set once client/container are usable
+	retrying  atomic.Bool          // set while the reconnect manager runs
 }
 
-var (
-	mu       sync.Mutex
-	accounts = make(map[uintptr]*accountState) // keyed by PurpleAccount pointer
+// incomingMessage is a fully extracted message, ready to cross the bridge.
+// Extraction happens on the event goroutine; the batcher only marshals.
+type incomingMessage struct {
+	senderJID string
+	chatJID   string
+	text      string
+	messageID string
+	pushName  string
+	timestamp int64
+	fromMe    bool
+	isGroup   bool
+}
+
+const (
+	// msgBatchMax bounds how many messages cross in one CGO call.
+	msgBatchMax = 64
+	// msgBatchWindow is how long the batcher waits for a burst to fill up
+	// before flushing a partial batch. Short enough to be invisible in
+	// interactive use, long enough to coalesce backfill bursts.
+	msgBatchWindow = 8 * time.Millisecond
+	// msgQueueDepth buffers bursts between the event handler and batcher.
+	msgQueueDepth = 512
 )
 
 // ──────────────────────────────────────────────────────────────────
@@ -58,67 +91,146 @@ var (
 // ──────────────────────────────────────────────────────────────────
 
 //export gowhatsapp_go_login
-func gowhatsapp_go_login(account C.gowhatsapp_account_t, phoneC *C.char) C.int {
+func gowhatsapp_go_login(account C.gowhatsapp_account_t, phoneC *C.char, fastStore C.int) C.int {
+	stats.cgoCallsIn.Add(1)
 	phone := C.GoString(phoneC)
 	key := uintptr(account)
 
-	mu.Lock()
-	defer mu.Unlock()
-
-	if _, exists := accounts[key]; exists {
+	if registry.lookup(key) != nil {
 		return -1 // already logged in
 	}
 
-	// Determine DB path inside purple config directory
+	// Determine paths inside the purple config directory
 	home, _ := os.UserHomeDir()
 	purpleDir := filepath.Join(home, ".purple", "whatsmeow")
 	os.MkdirAll(purpleDir, 0700)
-	dbPath := filepath.Join(purpleDir, fmt.Sprintf("%s.db", phone))
 
+	actx, cancel := context.WithCancel(context.Background())
+	state := &accountState{
+		ctx:      actx,
+		cancel:   cancel,
+		msgCh:    make(chan incomingMessage, msgQueueDepth),
+		sendCh:   make(chan outgoingSend, sendQueueDepth),
+		spool:    newSendSpool(filepath.Join(purpleDir, fmt.Sprintf("%s.spool", phone))),
+		archive:  newMessageArchive(filepath.Join(purpleDir, "archive", phone)),
+		presence: newPresenceCoalescer(),
+		receipts: newReceiptAccumulator(),
+		sent:     newSentIndex(),
+		acks:     newAckBatcher(),
+		dispatch: newEventDispatcher(),
+		dedup:    newDedupIndex(),
+		groups:   newGroupCache(filepath.Join(purpleDir, fmt.Sprintf("%s.groups.json", phone))),
+		avatars:  newAvatarEngine(filepath.Join(purpleDir, "avatars", phone)),
+		media:    newMediaDownloader(filepath.Join(purpleDir, "media")),
+	}
+	if !registry.insert(key, state) {
+		cancel()
+		return -1 // lost a race with a concurrent login
+	}
+
+	// Store open and connect happen off this thread: with several
+	// accounts, Pidgin startup fires N of these in parallel instead of
+	// serializing DB opens and WebSocket handshakes.
+	go connectAccount(account, state, phone, purpleDir, fastStore != 0)
+
+	return 0
+}
+
+// sessionDSN builds the sqlite DSN for the session store. Fast mode adds
+// WAL journaling (readers stop blocking the Signal ratchet writes), a
+// busy timeout instead of immediate SQLITE_BUSY during decryption
+// bursts, relaxed-but-durable syncs, and a larger per-connection page
+// cache for the pool database/sql maintains (each connection keeps its
+// prepared statements cached). Deliberately NOT shared-cache mode: its
+// table locks fail with SQLITE_LOCKED, which _busy_timeout does not
+// retry, and WAL already gives concurrent readers.
+func sessionDSN(dbPath string, fast bool) string {
+	if !fast {
+		return fmt.Sprintf("file:%s?_foreign_keys=on", dbPath)
+	}
+	return fmt.Sprintf("file:%s?_foreign_keys=on"+
+		"&_journal_mode=WAL"+
+		"&_busy_timeout=5000"+
+		"&_synchronous=NORMAL"+
+		"&_cache_size=-8192", // KiB of page cache
+		dbPath)
+}
+
+// connectAccount performs the slow half of login on a per-account
+// goroutine: open the session store, build the client, connect. Progress
+// is reported through bridge_connecting; fatal errors tear the purple
+// connection down via bridge_disconnected.
+func connectAccount(account C.gowhatsapp_account_t, state *accountState, phone, purpleDir string, fastStore bool) {
+	key := uintptr(account)
+	fail := func(msg string) {
+		reportError(account, msg)
+		registry.remove(key)
+		state.cancel()
+		C.bridge_disconnected(account)
+	}
+
+	reportConnecting(account, "Opening session store")
+
+	dbPath := filepath.Join(purpleDir, fmt.Sprintf("%s.db", phone))
 	logger := waLog.Stdout("WM", "WARN", true)
-	ctx := context.Background()
 
-	container, err := sqlstore.New(ctx, "sqlite3",
-		fmt.Sprintf("file:%s?_foreign_keys=on", dbPath), logger)
+	storeOpenStart := time.Now()
+	container, err := sqlstore.New(state.ctx, "sqlite3",
+		sessionDSN(dbPath, fastStore), logger)
 	if err != nil {
-		reportError(account, fmt.Sprintf("DB error: %v", err))
-		return -1
+		fail(fmt.Sprintf("DB error: %v", err))
+		return
 	}
 	os.Chmod(dbPath, 0600)
 
 	deviceStore, err := container.GetFirstDevice()
 	if err != nil {
-		reportError(account, fmt.Sprintf("Device store error: %v", err))
-		return -1
+		fail(fmt.Sprintf("Device store error: %v", err))
+		return
 	}
+	stats.storeOpenUS.Store(time.Since(storeOpenStart).Microseconds())
 
 	client := whatsmeow.NewClient(deviceStore, waLog.Stdout("Client", "WARN", true))
 
-	actx, cancel := context.WithCancel(context.Background())
-	state := &accountState{
-		client:    client,
-		container: container,
-		ctx:       actx,
-		cancel:    cancel,
-	}
-	accounts[key] = state
+	// Reconnection is owned by the bridge's own manager (reconnect.go),
+	// which backs off exponentially and keeps libpurple out of the loop
+	// until retries are exhausted.
+	client.EnableAutoReconnect = false
 
-	// Register event handler
+	// Register event handler — events fan out across the per-chat
+	// ordered worker pool instead of running on whatsmeow's goroutine.
 	client.AddEventHandler(func(evt interface{}) {
-		handleEvent(account, state, evt)
+		state.dispatch.submit(state, evt)
 	})
 
+	state.client = client
+	state.container = container
+	state.ready.Store(true) // publishes client/container to the hot paths
+
+	state.dispatch.start(account, state)
+	go runMessageBatcher(account, state)
+	go runSendWorker(account, state)
+	go runPresenceFlusher(account, state)
+	go runReceiptFlusher(account, state)
+	go runAckFlusher(account, state)
+
+	// Push persisted group metadata so chat user lists are populated
+	// before the socket is even up; a batched refresh follows connect.
+	go pushGroupCache(account, state)
+
+	reportConnecting(account, "Connecting")
+
 	// Connect
 	if client.Store.ID == nil {
 		// New login — need QR code
-		qrChan, err := client.GetQRChannel(ctx)
+		qrChan, err := client.GetQRChannel(state.ctx)
 		if err != nil {
-			reportError(account, fmt.Sprintf("QR channel error: %v", err))
-			return -1
+			fail(fmt.Sprintf("QR channel error: %v", err))
+			return
 		}
 		if err := client.Connect(); err != nil {
-			reportError(account, fmt.Sprintf("Connect error: %v", err))
-			return -1
+			fail(fmt.Sprintf("Connect error: %v", err))
+			return
 		}
 
 		go func() {
@@ -138,78 +250,44 @@ func gowhatsapp_go_login(account C.gowhatsapp_account_t, phoneC *C.char) C.int {
 	} else {
 		// Existing session
 		if err := client.Connect(); err != nil {
-			reportError(account, fmt.Sprintf("Reconnect error: %v", err))
-			return -1
+			fail(fmt.Sprintf("Reconnect error: %v", err))
+			return
 		}
 	}
+}
 
-	return 0
+// reportConnecting surfaces a login progress stage to the C side.
+func reportConnecting(account C.gowhatsapp_account_t, stage string) {
+	cStage := C.CString(stage)
+	C.bridge_connecting(account, cStage)
+	C.free(unsafe.Pointer(cStage))
 }
 
 //export gowhatsapp_go_logout
 func gowhatsapp_go_logout(account C.gowhatsapp_account_t) {
 	key := uintptr(account)
 
-	mu.Lock()
-	state, ok := accounts[key]
-	if ok {
-		delete(accounts, key)
-	}
-	mu.Unlock()
-
-	if ok && state.client != nil {
+	state := registry.remove(key)
+	if state != nil {
 		state.cancel()
-		state.client.Disconnect()
-	}
-}
-
-//export gowhatsapp_go_send_message
-func gowhatsapp_go_send_message(account C.gowhatsapp_account_t, jidC *C.char, textC *C.char) C.int {
-	jidStr := C.GoString(jidC)
-	text := C.GoString(textC)
-	key := uintptr(account)
-
-	mu.Lock()
-	state, ok := accounts[key]
-	mu.Unlock()
-
-	if !ok || state.client == nil {
-		return -1
-	}
-
-	targetJID, err := types.ParseJID(jidStr)
-	if err != nil {
-		reportError(account, fmt.Sprintf("Invalid JID %q: %v", jidStr, err))
-		return -1
-	}
-
-	msg := &waE2E.Message{
-		Conversation: proto.String(text),
-	}
-
-	_, err = state.client.SendMessage(context.Background(), targetJID, msg)
-	if err != nil {
-		reportError(account, fmt.Sprintf("Send failed: %v", err))
-		return -1
+		if state.ready.Load() {
+			state.client.Disconnect()
+		}
 	}
-
-	return 0
 }
 
 //export gowhatsapp_go_send_typing
 func gowhatsapp_go_send_typing(account C.gowhatsapp_account_t, jidC *C.char, typing C.int) {
+	stats.cgoCallsIn.Add(1)
 	jidStr := C.GoString(jidC)
 	key := uintptr(account)
 
-	mu.Lock()
-	state, ok := accounts[key]
-	mu.Unlock()
-
-	if !ok || state.client == nil {
+	state := registry.lookup(key)
+	if state == nil || !state.ready.Load() {
 		return
 	}
 
-	targetJID, err := types.ParseJID(jidStr)
+	targetJID, err := parseJIDCached(jidStr)
 	if err != nil {
 		return
 	}
@@ -222,27 +300,6 @@ func gowhatsapp_go_send_typing(account C.gowhatsapp_account_t, jidC *C.char, typ
 	}
 }
 
-//export gowhatsapp_go_mark_read
-func gowhatsapp_go_mark_read(account C.gowhatsapp_account_t, jidC *C.char, msgIDC *C.char, senderC *C.char) {
-	jidStr := C.GoString(jidC)
-	msgID := C.GoString(msgIDC)
-	senderStr := C.GoString(senderC)
-	key := uintptr(account)
-
-	mu.Lock()
-	state, ok := accounts[key]
-	mu.Unlock()
-
-	if !ok || state.client == nil || msgID == "" {
-		return
-	}
-
-	chatJID, _ := types.ParseJID(jidStr)
-	senderJID, _ := types.ParseJID(senderStr)
-
-	state.client.MarkRead([]types.MessageID{msgID}, chatJID, senderJID, chatJID)
-}
-
 // ──────────────────────────────────────────────────────────────────
 // Event handling — dispatches whatsmeow events to C callbacks
 // ──────────────────────────────────────────────────────────────────
@@ -254,9 +311,15 @@ func handleEvent(account C.gowhatsapp_account_t, state *accountState, evt interf
 
 	case *events.Connected:
 		C.bridge_connected(account)
+		go flushSendSpool(account, state)
+		go syncRoster(account, state)
+		go warmGroupCache(account, state)
+		go prefetchAvatars(account, state)
 
 	case *events.Disconnected:
-		C.bridge_disconnected(account)
+		// Network drop — try to resume on the warm state before
+		// involving libpurple; only exhausted retries surface an error.
+		startReconnect(account, state)
 
 	case *events.LoggedOut:
 		cReason := C.CString(fmt.Sprintf("Logged out: %s", v.Reason))
@@ -264,29 +327,37 @@ func handleEvent(account C.gowhatsapp_account_t, state *accountState, evt interf
 		C.free(unsafe.Pointer(cReason))
 
 	case *events.Presence:
-		cJID := C.CString(v.From.String())
-		available := C.int(0)
-		if v.Unavailable == false {
+		available := int32(0)
+		if !v.Unavailable {
 			available = 1
 		}
-		C.bridge_presence_update(account, cJID, available)
-		C.free(unsafe.Pointer(cJID))
+		state.presence.record(v.From.String(), presenceKindAvailability, available)
 
 	case *events.ChatPresence:
-		cJID := C.CString(v.MessageSource.Sender.String())
-		composing := C.int(0)
+		composing := int32(0)
 		if v.State == types.ChatPresenceComposing {
 			composing = 1
 		}
-		C.bridge_typing_notification(account, cJID, composing)
-		C.free(unsafe.Pointer(cJID))
+		state.presence.record(v.MessageSource.Sender.String(), presenceKindTyping, composing)
+
+	case *events.HistorySync:
+		// Heavy: runs off the event goroutine with bounded memory.
+		go ingestHistorySync(account, state, v)
 
 	case *events.Receipt:
-		// Could handle read receipts here
+		state.acks.record(state, v)
+
+	case *events.GroupInfo:
+		handleGroupInfo(account, state, v)
+
+	case *events.Picture:
+		handlePicture(account, state, v)
 	}
 }
 
-func handleMessage(account C.gowhatsapp_account_t, state *accountState, v *events.Message) {
+// extractMessage reduces a whatsmeow message event to the fields the
+// bridge delivers. ok is false when there is nothing displayable.
+func extractMessage(v *events.Message) (msg incomingMessage, ok bool) {
 	// Extract text content
 	var text string
 	if conv := v.Message.GetConversation(); conv != "" {
@@ -310,32 +381,134 @@ func handleMessage(account C.gowhatsapp_account_t, state *accountState, v *event
 	}
 
 	if text == "" {
+		return incomingMessage{}, false
+	}
+
+	return incomingMessage{
+		senderJID: v.Info.Sender.String(),
+		chatJID:   v.Info.Chat.String(),
+		text:      text,
+		messageID: v.Info.ID,
+		pushName:  v.Info.PushName,
+		timestamp: v.Info.Timestamp.Unix(),
+		fromMe:    v.Info.IsFromMe,
+		isGroup:   v.Info.IsGroup,
+	}, true
+}
+
+func handleMessage(account C.gowhatsapp_account_t, state *accountState, v *events.Message) {
+	// Drop re-deliveries before any archive write or bridge crossing.
+	if state.dedup.seen(v.Info.Chat.String(), v.Info.ID) {
+		return
+	}
+
+	if state.media.shouldHandle(v) {
+		go state.media.fetch(account, state, v)
 		return
 	}
 
-	cSenderJID := C.CString(v.Info.Sender.String())
-	cChatJID := C.CString(v.Info.Chat.String())
-	cText := C.CString(text)
-	cMsgID := C.CString(v.Info.ID)
-	cPushName := C.CString(v.Info.PushName)
-	cTimestamp := C.long(v.Info.Timestamp.Unix())
-	cFromMe := C.int(0)
-	if v.Info.IsFromMe {
-		cFromMe = 1
+	msg, ok := extractMessage(v)
+	if !ok {
+		return
 	}
-	cIsGroup := C.int(0)
-	if v.Info.IsGroup {
-		cIsGroup = 1
+
+	state.archive.append(msg.chatJID, msg)
+
+	select {
+	case state.msgCh <- msg:
+	case <-state.ctx.Done():
 	}
+}
 
-	C.bridge_receive_message(account, cSenderJID, cChatJID, cText, cMsgID,
-		cPushName, cTimestamp, cFromMe, cIsGroup)
+// runMessageBatcher drains the per-account message queue and delivers
+// messages to C in batches: one CGO crossing per batch instead of one per
+// message. A batch flushes when it reaches msgBatchMax or when
+// msgBatchWindow elapses after the first message, whichever comes first.
+func runMessageBatcher(account C.gowhatsapp_account_t, state *accountState) {
+	for {
+		select {
+		case first := <-state.msgCh:
+			batch := make([]incomingMessage, 1, msgBatchMax)
+			batch[0] = first
+			timer := time.NewTimer(msgBatchWindow)
+		fill:
+			for len(batch) < msgBatchMax {
+				select {
+				case m := <-state.msgCh:
+					batch = append(batch, m)
+				case <-timer.C:
+					break fill
+				case <-state.ctx.Done():
+					timer.Stop()
+					return
+				}
+			}
+			timer.Stop()
+			deliverMessageBatch(account, batch)
+
+		case <-state.ctx.Done():
+			return
+		}
+	}
+}
 
-	C.free(unsafe.Pointer(cSenderJID))
-	C.free(unsafe.Pointer(cChatJID))
-	C.free(unsafe.Pointer(cText))
-	C.free(unsafe.Pointer(cMsgID))
-	C.free(unsafe.Pointer(cPushName))
+// deliverMessageBatch packs a batch into a single C allocation — the
+// bridge_message_t array followed by a string arena — and makes the single
+// bridge_receive_messages crossing. One malloc and one free per batch,
+// regardless of message count.
+func deliverMessageBatch(account C.gowhatsapp_account_t, batch []incomingMessage) {
+	count := len(batch)
+	if count == 0 {
+		return
+	}
+	stats.messagesIn.Add(uint64(count))
+	stats.messageBatches.Add(1)
+
+	structBytes := count * C.sizeof_bridge_message_t
+	arenaBytes := 0
+	for _, m := range batch {
+		// Five strings per message, each NUL-terminated in the arena.
+		arenaBytes += len(m.senderJID) + len(m.chatJID) + len(m.text) +
+			len(m.messageID) + len(m.pushName) + 5
+	}
+
+	base := C.malloc(C.size_t(structBytes + arenaBytes))
+	msgs := unsafe.Slice((*C.bridge_message_t)(base), count)
+	arenaPtr := unsafe.Add(base, structBytes)
+	arena := unsafe.Slice((*byte)(arenaPtr), arenaBytes)
+
+	pos := 0
+	put := func(s string) C.uint32_t {
+		off := pos
+		copy(arena[pos:], s)
+		pos += len(s)
+		arena[pos] = 0
+		pos++
+		return C.uint32_t(off)
+	}
+
+	for i, m := range batch {
+		msgs[i].sender_jid_off = put(m.senderJID)
+		msgs[i].chat_jid_off = put(m.chatJID)
+		msgs[i].text_off = put(m.text)
+		msgs[i].message_id_off = put(m.messageID)
+		msgs[i].push_name_off = put(m.pushName)
+		msgs[i].timestamp = C.int64_t(m.timestamp)
+		msgs[i].from_me = boolToC(m.fromMe)
+		msgs[i].is_group = boolToC(m.isGroup)
+	}
+
+	C.bridge_receive_messages(account, (*C.bridge_message_t)(base),
+		C.int(count), (*C.char)(arenaPtr), C.int(arenaBytes))
+
+	C.free(base)
+}
+
+func boolToC(b bool) C.int32_t {
+	if b {
+		return 1
+	}
+	return 0
 }
 
 // reportError sends an error string to the C side.